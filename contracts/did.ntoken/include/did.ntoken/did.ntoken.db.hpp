@@ -7,11 +7,13 @@
 #include <eosio/time.hpp>
 
 // #include <deque>
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <map>
 #include <set>
 #include <type_traits>
+#include <limits>
 
 namespace flon {
 
@@ -19,16 +21,71 @@ using namespace std;
 using namespace eosio;
 
 #define HASH256(str) sha256(const_cast<char*>(str.c_str()), str.size())
+/// like check(), but `msg` is only built when `exp` fails
+#define CHECK(exp, msg) do { if (!(exp)) eosio::check(false, msg); } while (0)
 #define TBL struct [[eosio::table, eosio::contract("did.ntoken")]]
 #define NTBL(name) struct [[eosio::table(name), eosio::contract("did.ntoken")]]
 
 NTBL("global") global_t {
-    set<name> notaries;
+    vector<name> notaries; //sorted
+
+    /// `names` is kept sorted, so lookups are a binary search over one flat buffer
+    static bool contains( const vector<name>& names, const name& n ) {
+        return std::binary_search( names.begin(), names.end(), n );
+    }
+    static void insert( vector<name>& names, const name& n ) {
+        auto itr = std::lower_bound( names.begin(), names.end(), n );
+        if ( itr == names.end() || *itr != n ) names.insert( itr, n );
+    }
+    static bool erase( vector<name>& names, const name& n ) {
+        auto itr = std::lower_bound( names.begin(), names.end(), n );
+        if ( itr == names.end() || *itr != n ) return false;
+        names.erase( itr );
+        return true;
+    }
 
     EOSLIB_SERIALIZE( global_t, (notaries) )
 };
 typedef eosio::singleton< "global"_n, global_t > global_singleton;
 
+/**
+ * Contract-wide aggregates, kept up to date in O(1) by every action that
+ * adds or removes tokens, supply or balance rows.
+ *
+ * Rows that existed before the counters were introduced are folded in by
+ * `initstats`, which walks `tokenstats` by id and the `accounts` scopes by
+ * owner name. A row is only counted live once the backfill has passed it,
+ * i.e. `has_token(id)` / `has_owner(owner)`, so nothing is counted twice.
+ * Until `initstats` has run, every counter therefore stays 0. The exception is a
+ * contract whose first `gstats` row is written while it holds no tokens: both cursors
+ * then start at their MAX and every row is counted live from the start.
+ */
+static constexpr uint32_t MAX_TOKEN_CURSOR  = std::numeric_limits<uint32_t>::max();
+static constexpr name     MAX_OWNER_CURSOR  = name( std::numeric_limits<uint64_t>::max() );
+
+NTBL("gstats") gstats_t {
+    uint64_t    tokens          = 0;    // tokenstats rows
+    uint64_t    notarized       = 0;    // tokens carrying a notary
+    int64_t     supply          = 0;    // sum of all token supplies
+    uint64_t    holders         = 0;    // owners holding at least one balance row
+    uint64_t    balances        = 0;    // accounts rows across all owners
+    uint32_t    token_cursor    = 0;    // backfill: next token id to scan, MAX_TOKEN_CURSOR when done
+    name        owner_cursor;           // backfill: last owner scope counted, MAX_OWNER_CURSOR when done
+
+    bool has_token(const uint32_t& id)const  { return id < token_cursor; }
+    bool has_owner(const name& owner)const   { return owner.value <= owner_cursor.value; }
+    uint64_t rows()const                     { return tokens + balances; }
+
+    bool operator==(const gstats_t& o)const {
+        return tokens == o.tokens && notarized == o.notarized && supply == o.supply && holders == o.holders
+            && balances == o.balances && token_cursor == o.token_cursor && owner_cursor == o.owner_cursor;
+    }
+    bool operator!=(const gstats_t& o)const  { return !( *this == o ); }
+
+    EOSLIB_SERIALIZE( gstats_t, (tokens)(notarized)(supply)(holders)(balances)(token_cursor)(owner_cursor) )
+};
+typedef eosio::singleton< "gstats"_n, gstats_t > gstats_singleton;
+
 struct nsymbol {
     uint32_t id;
     uint32_t pid;       //Parent ID
@@ -109,6 +166,20 @@ TBL nstats_t {
                                 (ipowner)(notary)(issuer)(issued_at)(notarized_at)(paused) )
 };
 
+///Scope: self, a parent id whose whole collection is frozen: no issue or transfer of its tokens
+TBL pause_t {
+    uint32_t        pid;            //PK
+    time_point_sec  paused_at;
+
+    pause_t() {}
+
+    uint64_t primary_key()const { return pid; }
+
+    EOSLIB_SERIALIZE(pause_t, (pid)(paused_at) )
+
+    typedef eosio::multi_index< "pauses"_n, pause_t > idx_t;
+};
+
 ///Scope: owner's account
 TBL account_t {
     nasset      balance;
@@ -126,4 +197,59 @@ TBL account_t {
     typedef eosio::multi_index< "accounts"_n, account_t > idx_t;
 };
 
+/**
+ * Progress of the supply audit, which checks that every `tokenstats` supply equals the
+ * sum of its holders' balances. A pass first sums the `accounts` scopes handed in by the
+ * caller (ascending owner names), then compares the sums against `tokenstats` by id.
+ */
+NTBL("auditstate") auditstate_t {
+    enum phase_t: uint8_t { IDLE = 0, SUMMING = 1, COMPARING = 2 };
+
+    uint32_t        pass            = 0;    // number of the running or last completed pass
+    uint8_t         phase           = IDLE;
+    name            owner_cursor;           // SUMMING: last owner scope summed, MAX_OWNER_CURSOR once comparing
+    uint32_t        token_cursor    = 0;    // COMPARING: next token id to compare
+    uint64_t        rows            = 0;    // balance rows summed so far in this pass
+    uint32_t        mismatches      = 0;    // mismatches found so far in this pass
+    time_point_sec  started_at;
+    time_point_sec  finished_at;
+
+    // balance changes of summed owners are added to the sums of the running pass
+    bool has_owner(const name& owner)const   { return phase != IDLE && owner.value <= owner_cursor.value; }
+
+    EOSLIB_SERIALIZE( auditstate_t, (pass)(phase)(owner_cursor)(token_cursor)(rows)(mismatches)(started_at)(finished_at) )
+};
+typedef eosio::singleton< "auditstate"_n, auditstate_t > auditstate_singleton;
+
+///Scope: self, partial balance sum of a token in audit pass `pass`; rows of older passes count as zero
+TBL auditsum_t {
+    uint32_t        id;             //PK: token id
+    uint32_t        pass;
+    int64_t         balances;
+
+    auditsum_t() {}
+
+    uint64_t primary_key()const { return id; }
+
+    EOSLIB_SERIALIZE(auditsum_t, (id)(pass)(balances) )
+
+    typedef eosio::multi_index< "auditsums"_n, auditsum_t > idx_t;
+};
+
+///Scope: self, a token whose supply did not match its balances in audit pass `pass`
+TBL auditdiff_t {
+    uint32_t        id;             //PK: token id
+    uint32_t        pass;
+    int64_t         supply;
+    int64_t         balances;
+
+    auditdiff_t() {}
+
+    uint64_t primary_key()const { return id; }
+
+    EOSLIB_SERIALIZE(auditdiff_t, (id)(pass)(supply)(balances) )
+
+    typedef eosio::multi_index< "auditdiffs"_n, auditdiff_t > idx_t;
+};
+
 } //namespace flon
\ No newline at end of file
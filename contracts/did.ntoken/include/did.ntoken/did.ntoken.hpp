@@ -7,6 +7,7 @@
 #include <string>
 
 #include <did.ntoken/did.ntoken.db.hpp>
+#include <did.ntoken/table_cache.hpp>
 
 namespace flon {
 
@@ -29,12 +30,24 @@ class [[eosio::contract("did.ntoken")]] didtoken : public contract {
       using contract::contract;
 
    didtoken(eosio::name receiver, eosio::name code, datastream<const char*> ds): contract(receiver, code, ds),
-        _global(get_self(), get_self().value)
+        _global(get_self(), get_self().value),
+        _global_stats(get_self(), get_self().value)
     {
         _gstate = _global.exists() ? _global.get() : global_t{};
+        if ( _global_stats.exists() ) {
+           _gstats        = _global_stats.get();
+           _gstats_saved  = _gstats;
+        } else if ( _nstats().begin() == _nstats().end() ) {
+           // nothing to backfill: count every row live from the start
+           _gstats.token_cursor = MAX_TOKEN_CURSOR;
+           _gstats.owner_cursor = MAX_OWNER_CURSOR;
+        }
     }
 
-    ~didtoken() { _global.set( _gstate, get_self() ); }
+    ~didtoken() {
+      _global.set( _gstate, get_self() );
+      if ( _gstats_saved != _gstats ) _global_stats.set( _gstats, get_self() );
+   }
 
    /**
     * @brief Allows `issuer` account to create a token in supply of `maximum_supply`. If validation is successful a new entry in statsta
@@ -98,16 +111,78 @@ class [[eosio::contract("did.ntoken")]] didtoken : public contract {
     */
    ACTION notarize(const name& notary, const uint32_t& token_id);
 
+   /**
+    * @brief notary to notarize many NFT assets at once, skipping those it already notarized
+    *
+    * @param notary
+    * @param token_ids
+    * @return ACTION
+    */
+   ACTION notarizebatch(const name& notary, const vector<uint32_t>& token_ids);
+
+   /**
+    * @brief freeze or unfreeze every token under parent `pid` with a single row
+    *
+    * @param pid - parent id of the collection
+    * @param paused - true to freeze, false to unfreeze
+    * @return ACTION
+    */
+   ACTION pausepid(const uint32_t& pid, const bool& paused);
+
 
    ACTION setacctperms(const name& issuer, const name& to, const nsymbol& symbol,  const bool& allowsend, const bool& allowrecv);
 
+   /**
+    * @brief backfill the `gstats` aggregates with rows created before they were tracked.
+    *        First walks `tokenstats` in chunks of `max_rows` (owners must be empty), then counts
+    *        the `accounts` scopes passed in `owners`, which must be strictly ascending across calls.
+    *        An empty `owners` list after the token walk marks the backfill as complete.
+    *        Not needed when the first `gstats` row was written on a contract without tokens.
+    *
+    * @param max_rows - upper bound of rows to read in this call
+    * @param owners - next owner scopes to count, e.g. from `get_table_by_scope`
+    */
+   ACTION initstats( const uint32_t& max_rows, const vector<name>& owners );
+
+   /**
+    * @brief runs the supply audit in bounded chunks, starting a new pass when none is running.
+    *        While summing, `owners` are the next `accounts` scopes in ascending order and an empty
+    *        list ends the summing; while comparing, up to `max_rows` tokens are checked per call.
+    *        Mismatches of a pass are kept in `auditdiffs`, progress in `auditstate`.
+    *
+    *        Balances of owners already summed keep changing between chunks, so issue, retire,
+    *        transfer, burn and reclaim add their change to the sums of the running pass.
+    *
+    * @param max_rows - upper bound of rows to read in this call
+    * @param owners - next owner scopes to sum
+    */
+   ACTION audit( const uint32_t& max_rows, const vector<name>& owners );
+
+   static gstats_t get_stats( const name& contract ) {
+      auto gstats = gstats_singleton( contract, contract.value );
+      return gstats.get_or_default();
+   }
+
+   static auditstate_t get_audit( const name& contract ) {
+      auto state = auditstate_singleton( contract, contract.value );
+      return state.get_or_default();
+   }
+
 
    private:
       void add_balance( const name& owner, const nasset& value, const name& ram_payer );
       void sub_balance( const name& owner, const nasset& value );
+      void _count_balance_row( const name& owner, const account_t::idx_t& acnts );
+      void _check_not_paused( const nsymbol& sym );
+      void _audit_balance( const name& owner, const nsymbol& sym, const int64_t& delta );
+
+      nstats_t::idx_t& _nstats()                         { return _stats_tables.get( _self, _self.value ); }
+      account_t::idx_t& _accounts( const name& owner )   { return _acnt_tables.get( _self, owner.value ); }
+      pause_t::idx_t& _pauses()                          { return _pause_tables.get( _self, _self.value ); }
+      auditsum_t::idx_t& _auditsums()                    { return _sum_tables.get( _self, _self.value ); }
 
       inline void require_issuer(const name& issuer, const nsymbol& sym) {
-         nstats_t::idx_t tokenstats( get_self(), sym.raw() );
+         auto& tokenstats = _stats_tables.get( get_self(), sym.raw() );
          auto existing = tokenstats.find( sym.raw() );
          check( existing != tokenstats.end(), "token with symbol does not exist, create token before issue" );
          const auto& st = *existing;
@@ -116,5 +191,13 @@ class [[eosio::contract("did.ntoken")]] didtoken : public contract {
    private:
       global_singleton    _global;
       global_t            _gstate;
+      gstats_singleton    _global_stats;
+      gstats_t            _gstats;
+      std::optional<gstats_t> _gstats_saved;   // as loaded, nullopt when the row does not exist yet
+      table_cache<nstats_t>    _stats_tables;
+      table_cache<account_t>   _acnt_tables;
+      table_cache<pause_t>     _pause_tables;
+      table_cache<auditsum_t>  _sum_tables;
+      std::optional<auditstate_t> _auditstate;  // loaded by the first balance change of an action
 };
 } //namespace flon
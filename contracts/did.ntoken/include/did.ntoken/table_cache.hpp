@@ -0,0 +1,36 @@
+#pragma once
+
+#include <eosio/eosio.hpp>
+
+#include <map>
+#include <tuple>
+#include <utility>
+
+namespace flon {
+
+/**
+ * Holds one multi_index handle per (code, scope) of table `T` for the lifetime of an action.
+ *
+ * The table itself is fixed by `T::idx_t`, so together with the (code, scope) key every
+ * handle is unique per (code, scope, table). Helpers sharing a handle also share its
+ * row cache, so a row read by one of them is not looked up again by the next.
+ */
+template<typename T>
+class table_cache {
+   public:
+      using idx_t = typename T::idx_t;
+
+      idx_t& get( const eosio::name& code, const uint64_t& scope ) {
+         auto key = std::make_pair( code.value, scope );
+         auto itr = _tables.find( key );
+         if ( itr == _tables.end() )
+            itr = _tables.emplace( std::piecewise_construct, std::forward_as_tuple( key ),
+                                   std::forward_as_tuple( code, scope ) ).first;
+         return itr->second;
+      }
+
+   private:
+      std::map< std::pair<uint64_t, uint64_t>, idx_t > _tables;
+};
+
+} //namespace flon
@@ -13,19 +13,21 @@ void didtoken::create( const name& issuer, const int64_t& maximum_supply, const
    check( token_uri.length() < 1024, "token uri length > 1024" );
 
    auto nsymb           = symbol;
-   auto nstats          = nstats_t::idx_t( _self, _self.value );
+   auto& nstats         = _nstats();
    auto idx             = nstats.get_index<"tokenuriidx"_n>();
    auto token_uri_hash  = HASH256(token_uri);
    // auto lower_itr = idx.lower_bound( token_uri_hash );
    // auto upper_itr = idx.upper_bound( token_uri_hash );
    // check( lower_itr == idx.end() || lower_itr == upper_itr, "token with token_uri already exists" );
    check( idx.find(token_uri_hash) == idx.end(), "token with token_uri already exists" );
-   check( nstats.find(nsymb.id) == nstats.end(), "token of ID: " + to_string(nsymb.id) + " alreay exists" );
+   CHECK( nstats.find(nsymb.id) == nstats.end(), "token of ID: " + to_string(nsymb.id) + " alreay exists" );
    if (nsymb.id != 0)
       check( nsymb.id != nsymb.pid, "parent id shall not be equal to id" );
    else
       nsymb.id         = nstats.available_primary_key();
 
+   if ( _gstats.has_token(nsymb.id) ) _gstats.tokens++;
+
    nstats.emplace( issuer, [&]( auto& s ) {
       s.supply.symbol   = nsymb;
       s.max_supply      = nasset( maximum_supply, symbol );
@@ -40,17 +42,17 @@ void didtoken::setnotary(const name& notary, const bool& to_add) {
    require_auth( _self );
 
    if (to_add)
-      _gstate.notaries.insert(notary);
+      global_t::insert( _gstate.notaries, notary );
 
    else
-      _gstate.notaries.erase(notary);
+      global_t::erase( _gstate.notaries, notary );
 
 }
 
 void didtoken::settokenuri(const uint64_t& symbid, const string& url) {
    check( has_auth("armoniaadmin"_n) || has_auth(_self), "non authorized" );
 
-   auto nstats          = nstats_t::idx_t( _self, _self.value );
+   auto& nstats         = _nstats();
    auto itr             = nstats.find( symbid );
    check( itr != nstats.end(), "nft not found" );
 
@@ -61,24 +63,69 @@ void didtoken::settokenuri(const uint64_t& symbid, const string& url) {
 
 void didtoken::notarize(const name& notary, const uint32_t& token_id) {
    require_auth( notary );
-   check( _gstate.notaries.find(notary) != _gstate.notaries.end(), "not authorized notary" );
+   check( global_t::contains( _gstate.notaries, notary ), "not authorized notary" );
 
-   auto nstats = nstats_t::idx_t( _self, _self.value );
+   auto& nstats = _nstats();
    auto itr = nstats.find( token_id );
-   check( itr != nstats.end(), "token not found: " + to_string(token_id) );
+   CHECK( itr != nstats.end(), "token not found: " + to_string(token_id) );
+   if ( itr->notary.value == 0 && _gstats.has_token(token_id) ) _gstats.notarized++;
+
    nstats.modify( itr, same_payer, [&]( auto& row ) {
       row.notary = notary;
       row.notarized_at = time_point_sec( current_time_point()  );
     });
 }
 
+void didtoken::notarizebatch(const name& notary, const vector<uint32_t>& token_ids) {
+   require_auth( notary );
+   check( global_t::contains( _gstate.notaries, notary ), "not authorized notary" );
+   check( token_ids.size() > 0, "no token ids" );
+
+   auto& nstats = _nstats();
+   auto now = time_point_sec( current_time_point() );
+   for( auto& id : token_ids ) {
+      auto itr = nstats.find( id );
+      CHECK( itr != nstats.end(), "token not found: " + to_string(id) );
+      if ( itr->notary == notary ) continue;
+      if ( itr->notary.value == 0 && _gstats.has_token(id) ) _gstats.notarized++;
+
+      nstats.modify( itr, same_payer, [&]( auto& row ) {
+         row.notary = notary;
+         row.notarized_at = now;
+      });
+   }
+}
+
+void didtoken::pausepid(const uint32_t& pid, const bool& paused) {
+   require_auth( _self );
+
+   auto& pauses = _pauses();
+   auto itr = pauses.find( pid );
+   if ( paused ) {
+      CHECK( itr == pauses.end(), "parent already paused: " + to_string(pid) );
+      pauses.emplace( _self, [&]( auto& p ) {
+         p.pid       = pid;
+         p.paused_at = current_time_point();
+      });
+   } else {
+      CHECK( itr != pauses.end(), "parent not paused: " + to_string(pid) );
+      pauses.erase( itr );
+   }
+}
+
+void didtoken::_check_not_paused( const nsymbol& sym ) {
+   auto& pauses = _pauses();
+   CHECK( pauses.find( sym.pid ) == pauses.end(), "token parent is paused: " + to_string(sym.pid) );
+}
+
 void didtoken::issue( const name& to, const nasset& quantity, const string& memo )
 {
     auto sym = quantity.symbol;
     check( sym.is_valid(), "invalid symbol name" );
     check( memo.size() <= 256, "memo has more than 256 bytes" );
+    _check_not_paused( sym );
 
-    auto nstats = nstats_t::idx_t( _self, _self.value );
+    auto& nstats = _nstats();
     auto existing = nstats.find( sym.id );
     check( existing != nstats.end(), "token with symbol does not exist, create token before issue" );
     const auto& st = *existing;
@@ -94,6 +141,7 @@ void didtoken::issue( const name& to, const nasset& quantity, const string& memo
     nstats.modify( st, same_payer, [&]( auto& s ) {
        s.supply += quantity;
     });
+    if ( _gstats.has_token(sym.id) ) _gstats.supply += quantity.amount;
 
     add_balance( st.issuer, quantity, st.issuer );
 }
@@ -104,7 +152,7 @@ void didtoken::retire( const nasset& quantity, const string& memo )
     check( sym.is_valid(), "invalid symbol name" );
     check( memo.size() <= 256, "memo has more than 256 bytes" );
 
-    auto nstats = nstats_t::idx_t( _self, _self.value );
+    auto& nstats = _nstats();
     auto existing = nstats.find( sym.id );
     check( existing != nstats.end(), "token with symbol does not exist" );
     const auto& st = *existing;
@@ -118,6 +166,7 @@ void didtoken::retire( const nasset& quantity, const string& memo )
     nstats.modify( st, same_payer, [&]( auto& s ) {
        s.supply -= quantity;
     });
+    if ( _gstats.has_token(sym.id) ) _gstats.supply -= quantity.amount;
 
     sub_balance( st.issuer, quantity );
 }
@@ -128,7 +177,7 @@ void didtoken::burn( const name& owner,const nasset& quantity, const string& mem
    check( sym.is_valid(), "invalid symbol name" );
    check( memo.size() <= 256, "memo has more than 256 bytes" );
 
-   auto nstats = nstats_t::idx_t( _self, _self.value );
+   auto& nstats = _nstats();
    auto existing = nstats.find( sym.id );
    check( existing != nstats.end(), "token with symbol does not exist" );
    const auto& st = *existing;
@@ -142,8 +191,9 @@ void didtoken::burn( const name& owner,const nasset& quantity, const string& mem
    nstats.modify( st, same_payer, [&]( auto& s ) {
       s.supply -= quantity;
    });
+   if ( _gstats.has_token(sym.id) ) _gstats.supply -= quantity.amount;
 
-   auto from_acnts = account_t::idx_t( get_self(), owner.value );
+   auto& from_acnts = _accounts( owner );
 
    const auto& from = from_acnts.get( quantity.symbol.raw(), "no balance object found" );
    check( from.balance.amount >= quantity.amount, "overdrawn balance" );
@@ -151,6 +201,7 @@ void didtoken::burn( const name& owner,const nasset& quantity, const string& mem
    from_acnts.modify( from, same_payer, [&]( auto& a ) {
       a.balance -= quantity;
    });
+   _audit_balance( owner, quantity.symbol, -quantity.amount );
 }
 
 void didtoken::reclaim( const name& target, const nsymbol& did, const string& memo ) {
@@ -158,7 +209,7 @@ void didtoken::reclaim( const name& target, const nsymbol& did, const string& me
    check( memo.size() <= 256, "memo has more than 256 bytes" );
 
    // sub_balance( target, quantity );
-   account_t::idx_t from_acnts( get_self(), target.value );
+   auto& from_acnts = _accounts( target );
    const auto& from = from_acnts.get( did.raw(), "no balance object found" );
    check( from.balance.amount >= 1, "DID not found" );
    auto prev_amount = from.balance.amount;
@@ -166,9 +217,10 @@ void didtoken::reclaim( const name& target, const nsymbol& did, const string& me
    from_acnts.modify( from, same_payer, [&]( auto& a ) {
       a.balance.amount = 0;
    });
+   _audit_balance( target, did, -prev_amount );
 
 
-   nstats_t::idx_t statstable( get_self(), did.raw() );
+   auto& statstable = _stats_tables.get( _self, did.raw() );
    auto existing = statstable.find( did.raw() );
    check( existing != statstable.end(), "token with symbol does not exist" );
    const auto& st = *existing;
@@ -176,6 +228,7 @@ void didtoken::reclaim( const name& target, const nsymbol& did, const string& me
    statstable.modify( st, same_payer, [&]( auto& s ) {
       s.supply.amount -= prev_amount;
    });
+   if ( _gstats.has_token(did.id) ) _gstats.supply -= prev_amount;
 
    require_recipient( target );
 }
@@ -194,13 +247,14 @@ void didtoken::transfer( const name& from, const name& to, const vector<nasset>&
    check (assets.size() == 1, "assets size must equal 1");
    for( auto& quantity : assets) {
       auto sym = quantity.symbol;
-      auto nstats = nstats_t::idx_t( _self, _self.value );
+      _check_not_paused( sym );
+      auto& nstats = _nstats();
       const auto& st = nstats.get( sym.id );
 
-      auto from_acnts = account_t::idx_t( get_self(), from.value );
+      auto& from_acnts = _accounts( from );
       const auto& from_acnt = from_acnts.get( quantity.symbol.raw(), "no balance object found" );
 
-      auto to_acnts = account_t::idx_t( get_self(), to.value );
+      auto& to_acnts = _accounts( to );
       auto to_acnt = to_acnts.find( quantity.symbol.raw() );
       check( to_acnt == to_acnts.end() || to_acnt->balance.amount == 0, "You can't receive more than one DID token" );
    
@@ -218,7 +272,7 @@ void didtoken::transfer( const name& from, const name& to, const vector<nasset>&
 }
 
 void didtoken::sub_balance( const name& owner, const nasset& value ) {
-   auto from_acnts = account_t::idx_t( get_self(), owner.value );
+   auto& from_acnts = _accounts( owner );
 
    const auto& from = from_acnts.get( value.symbol.raw(), "no balance object found" );
    check( from.balance.amount >= value.amount, "overdrawn balance" );
@@ -226,13 +280,15 @@ void didtoken::sub_balance( const name& owner, const nasset& value ) {
    from_acnts.modify( from, owner, [&]( auto& a ) {
       a.balance -= value;
    });
+   _audit_balance( owner, value.symbol, -value.amount );
 }
 
 void didtoken::add_balance( const name& owner, const nasset& value, const name& ram_payer )
 {
-   auto to_acnts = account_t::idx_t( get_self(), owner.value );
+   auto& to_acnts = _accounts( owner );
    auto to = to_acnts.find( value.symbol.raw() );
    if( to == to_acnts.end() ) {
+      _count_balance_row( owner, to_acnts );
       to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
@@ -241,20 +297,184 @@ void didtoken::add_balance( const name& owner, const nasset& value, const name&
         a.balance += value;
       });
    }
+   _audit_balance( owner, value.symbol, value.amount );
+}
+
+void didtoken::_audit_balance( const name& owner, const nsymbol& sym, const int64_t& delta ) {
+   if ( !_auditstate ) _auditstate = auditstate_singleton( _self, _self.value ).get_or_default();
+   if ( !_auditstate->has_owner(owner) ) return;
+
+   auto& sums = _auditsums();
+   auto pass = _auditstate->pass;
+   auto itr = sums.find( sym.id );
+   if ( itr == sums.end() ) {
+      sums.emplace( _self, [&]( auto& s ) {
+         s.id        = sym.id;
+         s.pass      = pass;
+         s.balances  = delta;
+      });
+   } else {
+      sums.modify( itr, same_payer, [&]( auto& s ) {
+         s.balances  = ( s.pass == pass ? s.balances : 0 ) + delta;
+         s.pass      = pass;
+      });
+   }
+}
+
+void didtoken::_count_balance_row( const name& owner, const account_t::idx_t& acnts ) {
+   if ( !_gstats.has_owner(owner) ) return;
+
+   if ( acnts.begin() == acnts.end() ) _gstats.holders++;
+   _gstats.balances++;
+}
+
+void didtoken::initstats( const uint32_t& max_rows, const vector<name>& owners ) {
+   require_auth( _self );
+   check( max_rows > 0, "max_rows must be positive" );
+
+   uint32_t rows = 0;
+   if ( _gstats.token_cursor != MAX_TOKEN_CURSOR ) {
+      check( owners.empty(), "tokenstats backfill not finished yet" );
+
+      auto& nstats = _nstats();
+      auto itr = nstats.lower_bound( _gstats.token_cursor );
+      for( ; itr != nstats.end() && rows < max_rows; itr++, rows++ ) {
+         _gstats.tokens++;
+         _gstats.supply += itr->supply.amount;
+         if ( itr->notary.value != 0 ) _gstats.notarized++;
+      }
+      _gstats.token_cursor = ( itr == nstats.end() ) ? MAX_TOKEN_CURSOR : itr->supply.symbol.id;
+      return;
+   }
+
+   check( _gstats.owner_cursor != MAX_OWNER_CURSOR, "stats already backfilled" );
+   if ( owners.empty() ) {
+      _gstats.owner_cursor = MAX_OWNER_CURSOR;
+      return;
+   }
+
+   // an owner scope is always counted as a whole, so the cursor never splits it
+   for( auto& owner : owners ) {
+      if ( rows >= max_rows ) break;
+      CHECK( owner.value > _gstats.owner_cursor.value, "owners must be ascending: " + owner.to_string() );
+
+      auto& acnts = _accounts( owner );
+      auto itr = acnts.begin();
+      if ( itr != acnts.end() ) _gstats.holders++;
+      for( ; itr != acnts.end(); itr++, rows++ )
+         _gstats.balances++;
+
+      _gstats.owner_cursor = owner;
+   }
+}
+
+void didtoken::audit( const uint32_t& max_rows, const vector<name>& owners ) {
+   require_auth( _self );
+   check( max_rows > 0, "max_rows must be positive" );
+
+   auto state_tbl = auditstate_singleton( _self, _self.value );
+   auto state = state_tbl.get_or_default();
+
+   if ( state.phase == auditstate_t::IDLE ) {
+      state.pass++;
+      state.phase           = auditstate_t::SUMMING;
+      state.owner_cursor    = name();
+      state.token_cursor    = 0;
+      state.rows            = 0;
+      state.mismatches      = 0;
+      state.started_at      = current_time_point();
+   }
+
+   auto& sums = _auditsums();
+   uint32_t rows = 0;
+
+   if ( state.phase == auditstate_t::SUMMING ) {
+      if ( owners.empty() ) {
+         // every owner is summed now, later balance changes keep the sums current
+         state.phase        = auditstate_t::COMPARING;
+         state.owner_cursor = MAX_OWNER_CURSOR;
+         state_tbl.set( state, _self );
+         return;
+      }
+
+      // summed in memory first so each token's checkpoint row is written once per chunk
+      map<uint32_t, int64_t> chunk;
+      for( auto& owner : owners ) {
+         if ( rows >= max_rows ) break;
+         CHECK( owner.value > state.owner_cursor.value, "owners must be ascending: " + owner.to_string() );
+
+         auto& acnts = _accounts( owner );
+         for( auto itr = acnts.begin(); itr != acnts.end(); itr++, rows++ )
+            chunk[ itr->balance.symbol.id ] += itr->balance.amount;
+
+         state.owner_cursor = owner;
+      }
+      state.rows += rows;
+
+      for( auto& [ id, amount ] : chunk ) {
+         auto itr = sums.find( id );
+         if ( itr == sums.end() ) {
+            sums.emplace( _self, [&]( auto& s ) {
+               s.id        = id;
+               s.pass      = state.pass;
+               s.balances  = amount;
+            });
+         } else {
+            sums.modify( itr, same_payer, [&]( auto& s ) {
+               s.balances  = ( s.pass == state.pass ? s.balances : 0 ) + amount;
+               s.pass      = state.pass;
+            });
+         }
+      }
+      state_tbl.set( state, _self );
+      return;
+   }
+
+   auto diffs = auditdiff_t::idx_t( _self, _self.value );
+   auto& nstats = _nstats();
+   auto itr = nstats.lower_bound( state.token_cursor );
+   for( ; itr != nstats.end() && rows < max_rows; itr++, rows++ ) {
+      auto id = itr->supply.symbol.id;
+      auto sum = sums.find( id );
+      int64_t balances = ( sum != sums.end() && sum->pass == state.pass ) ? sum->balances : 0;
+      if ( balances == itr->supply.amount ) continue;
+
+      state.mismatches++;
+      auto diff = diffs.find( id );
+      auto record = [&]( auto& d ) {
+         d.id        = id;
+         d.pass      = state.pass;
+         d.supply    = itr->supply.amount;
+         d.balances  = balances;
+      };
+      if ( diff == diffs.end() )
+         diffs.emplace( _self, record );
+      else
+         diffs.modify( diff, same_payer, record );
+   }
+
+   if ( itr == nstats.end() ) {
+      state.phase           = auditstate_t::IDLE;
+      state.finished_at     = current_time_point();
+   } else {
+      state.token_cursor    = itr->supply.symbol.id;
+   }
+   state_tbl.set( state, _self );
 }
 
 void didtoken::setacctperms(const name& issuer, const name& to, const nsymbol& symbol,  const bool& allowsend, const bool& allowrecv) {
    require_auth( issuer );
    check( is_account( to ), "to account does not exist");
 
-   auto nstats = nstats_t::idx_t( _self, _self.value );
+   auto& nstats = _nstats();
    const auto& st = nstats.get( symbol.id );
-   check( issuer == st.issuer, "issuer: " + st.issuer.to_string() + " vs " + issuer.to_string() );
+   CHECK( issuer == st.issuer, "issuer: " + st.issuer.to_string() + " vs " + issuer.to_string() );
 
-   auto acnts = account_t::idx_t( get_self(), to.value );
+   auto& acnts = _accounts( to );
    const auto& it = acnts.find( symbol.raw());
 
     if( it == acnts.end() ) {
+      _count_balance_row( to, acnts );
       acnts.emplace( issuer, [&]( auto& a ){
         a.balance = nasset(0, symbol);
         a.allow_send = allowsend;
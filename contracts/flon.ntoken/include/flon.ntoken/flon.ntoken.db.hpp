@@ -7,11 +7,13 @@
 #include <eosio/time.hpp>
 
 // #include <deque>
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <map>
 #include <set>
 #include <type_traits>
+#include <limits>
 
 namespace flon {
 
@@ -19,19 +21,97 @@ using namespace std;
 using namespace eosio;
 
 #define HASH256(str) sha256(const_cast<char*>(str.c_str()), str.size())
+/// like check(), but `msg` is only built when `exp` fails
+#define CHECK(exp, msg) do { if (!(exp)) eosio::check(false, msg); } while (0)
 #define TBL struct [[eosio::table, eosio::contract("flon.ntoken")]]
 #define NTBL(name) struct [[eosio::table(name), eosio::contract("flon.ntoken")]]
 
 static constexpr uint32_t U1E9  = 10'0000'0000UL;
 
 NTBL("global") global_t {
-    set<name> creators; //null means open to public
-    set<name> notaries;
+    vector<name> creators; //sorted, null means open to public
+    vector<name> notaries; //sorted
+
+    /// `names` is kept sorted, so lookups are a binary search over one flat buffer
+    static bool contains( const vector<name>& names, const name& n ) {
+        return std::binary_search( names.begin(), names.end(), n );
+    }
+    static void insert( vector<name>& names, const name& n ) {
+        auto itr = std::lower_bound( names.begin(), names.end(), n );
+        if ( itr == names.end() || *itr != n ) names.insert( itr, n );
+    }
+    static bool erase( vector<name>& names, const name& n ) {
+        auto itr = std::lower_bound( names.begin(), names.end(), n );
+        if ( itr == names.end() || *itr != n ) return false;
+        names.erase( itr );
+        return true;
+    }
 
     EOSLIB_SERIALIZE( global_t, (creators)(notaries) )
 };
 typedef eosio::singleton< "global"_n, global_t > global_singleton;
 
+/**
+ * Contract-wide aggregates, kept up to date in O(1) by every action that
+ * adds or removes tokens, supply or balance rows.
+ *
+ * Rows that existed before the counters were introduced are folded in by
+ * `initstats`, which walks `tokenstats` by id and the `accounts` scopes by
+ * owner name. A row is only counted live once the backfill has passed it,
+ * i.e. `has_token(id)` / `has_owner(owner)`, so nothing is counted twice.
+ * Until `initstats` has run, every counter therefore stays 0. The exception is a
+ * contract whose first `gstats` row is written while it holds no tokens: both cursors
+ * then start at their MAX and every row is counted live from the start.
+ */
+static constexpr uint32_t MAX_TOKEN_CURSOR  = std::numeric_limits<uint32_t>::max();
+static constexpr name     MAX_OWNER_CURSOR  = name( std::numeric_limits<uint64_t>::max() );
+
+NTBL("gstats") gstats_t {
+    uint64_t    tokens          = 0;    // token ids: tokenstats rows plus every id of every series
+    uint64_t    notarized       = 0;    // tokens carrying a notary
+    int64_t     supply          = 0;    // sum of all token supplies
+    uint64_t    holders         = 0;    // owners holding at least one balance row
+    uint64_t    balances        = 0;    // accounts rows across all owners
+    uint32_t    token_cursor    = 0;    // backfill: next token id to scan, MAX_TOKEN_CURSOR when done
+    name        owner_cursor;           // backfill: last owner scope counted, MAX_OWNER_CURSOR when done
+
+    bool has_token(const uint32_t& id)const  { return id < token_cursor; }
+    bool has_owner(const name& owner)const   { return owner.value <= owner_cursor.value; }
+    uint64_t rows()const                     { return tokens + balances; }
+
+    bool operator==(const gstats_t& o)const {
+        return tokens == o.tokens && notarized == o.notarized && supply == o.supply && holders == o.holders
+            && balances == o.balances && token_cursor == o.token_cursor && owner_cursor == o.owner_cursor;
+    }
+    bool operator!=(const gstats_t& o)const  { return !( *this == o ); }
+
+    EOSLIB_SERIALIZE( gstats_t, (tokens)(notarized)(supply)(holders)(balances)(token_cursor)(owner_cursor) )
+};
+typedef eosio::singleton< "gstats"_n, gstats_t > gstats_singleton;
+
+/**
+ * Sharding of `tokenstats` by id range. Once `shard_size` is set, the row of token `id`
+ * lives in scope `id / shard_size` instead of the contract's own scope. Rows created
+ * before are moved over by `migrateshard`; until `migrated` is set, lookups missing in a
+ * shard fall back to the contract scope.
+ */
+NTBL("shardconf") shardconf_t {
+    uint32_t    shard_size      = 0;        // ids per shard, 0 keeps every row in the (self, self) scope
+    uint32_t    next_id         = 0;        // id assigned by `create` when called with id 0
+    bool        migrated        = false;    // no rows left in the (self, self) scope
+
+    bool sharded()const                     { return shard_size > 0; }
+    uint64_t scope(const uint32_t& id)const { return id / shard_size; }
+
+    bool operator==(const shardconf_t& o)const {
+        return shard_size == o.shard_size && next_id == o.next_id && migrated == o.migrated;
+    }
+    bool operator!=(const shardconf_t& o)const  { return !( *this == o ); }
+
+    EOSLIB_SERIALIZE( shardconf_t, (shard_size)(next_id)(migrated) )
+};
+typedef eosio::singleton< "shardconf"_n, shardconf_t > shardconf_singleton;
+
 struct nsymbol {
     uint32_t id;
     uint32_t pid;
@@ -87,6 +167,36 @@ struct nasset {
     EOSLIB_SERIALIZE( nasset, (amount)(symbol) )
 };
 
+struct ntransfer {
+    name            from;
+    name            to;
+    nasset          quantity;
+
+    EOSLIB_SERIALIZE( ntransfer, (from)(to)(quantity) )
+};
+
+struct nrecipient {
+    name            to;
+    vector<nasset>  assets;
+
+    EOSLIB_SERIALIZE( nrecipient, (to)(assets) )
+};
+
+struct nattr {
+    uint8_t         tag;
+    vector<char>    value;          // empty removes the tag
+
+    EOSLIB_SERIALIZE( nattr, (tag)(value) )
+};
+
+struct nattrs {
+    uint32_t        id;             // token id, or parent id when `parent` is set
+    bool            parent;         // true: defaults inherited by the issuer's own tokens under parent `id`
+    vector<nattr>   attrs;
+
+    EOSLIB_SERIALIZE( nattrs, (id)(parent)(attrs) )
+};
+
 //Scope: self
 TBL nstats_t {
     nasset          supply;
@@ -123,6 +233,133 @@ TBL nstats_t {
     EOSLIB_SERIALIZE(nstats_t,  (supply)(max_supply)(token_uri)(ipowner)(notary)(issuer)(issued_at)(notarized_at)(paused) )
 };
 
+/**
+ * Scope: self
+ *
+ * A contiguous range of token ids `[first_id, last_id]` under one parent, sharing
+ * issuer, ipowner and per-id `max_supply`. Ids are issued in order, so a single
+ * `minted` counter tells which ids are in circulation. A `tokenstats` row is only
+ * materialized for an id once its metadata diverges from the range; from then on
+ * that row is authoritative for the id.
+ *
+ * Only `uri_base` is unique among series. The per-id uris `uri_base + id` are not
+ * checked against `tokenstats`/`tokenuris` nor against other bases (e.g. "a/1" + 2 and
+ * "a/" + 12), that would cost one lookup per id: series uris are outside the global
+ * `token_uri` uniqueness rule.
+ */
+TBL series_t {
+    uint32_t        last_id;        //PK: lower_bound(id) lands on the range holding id
+    uint32_t        first_id;
+    uint32_t        pid;
+    int64_t         max_supply;     // per token id, 1 means NFT-721 type
+    uint32_t        minted = 0;     // ids [first_id, first_id + minted) are fully issued
+    string          uri_base;       // token_uri of each id is uri_base + id
+    name            ipowner;
+    name            issuer;
+    time_point_sec  created_at;
+
+    series_t() {}
+
+    uint64_t primary_key()const                 { return last_id; }
+    uint32_t size()const                        { return last_id - first_id + 1; }
+    nsymbol symbol(const uint32_t& id)const     { return nsymbol(id, pid); }
+    string token_uri(const uint32_t& id)const   { return uri_base + to_string(id); }
+    int64_t supply(const uint32_t& id)const     { return ( id - first_id < minted ) ? max_supply : 0; }
+
+    uint64_t by_pid()const                      { return pid; }
+    checksum256 by_uri_base()const              { return HASH256(uri_base); }
+
+    typedef eosio::multi_index
+    < "series"_n,  series_t,
+        indexed_by<"parentidx"_n,       const_mem_fun<series_t, uint64_t, &series_t::by_pid> >,
+        indexed_by<"uribaseidx"_n,      const_mem_fun<series_t, checksum256, &series_t::by_uri_base> >
+    > idx_t;
+
+    EOSLIB_SERIALIZE(series_t, (last_id)(first_id)(pid)(max_supply)(minted)(uri_base)(ipowner)(issuer)(created_at) )
+};
+
+/**
+ * Scope: self
+ *
+ * Keeps `token_uri` globally unique once `tokenstats` is sharded and its per-scope
+ * `tokenuriidx` index only covers one shard. Keyed by the leading 64 bits of the uri hash.
+ */
+TBL tokenuri_t {
+    uint64_t        key;            //PK: leading 64 bits of sha256(token_uri)
+    uint32_t        id;             // token holding the uri
+
+    tokenuri_t() {}
+
+    uint64_t primary_key()const { return key; }
+
+    static uint64_t key_of(const string& token_uri) {
+        auto bytes = HASH256(token_uri).extract_as_byte_array();
+        uint64_t key = 0;
+        for (int i = 0; i < 8; i++) key = key << 8 | bytes[i];
+        return key;
+    }
+
+    EOSLIB_SERIALIZE(tokenuri_t, (key)(id) )
+
+    typedef eosio::multi_index< "tokenuris"_n, tokenuri_t > idx_t;
+};
+
+/**
+ * Scope: self for token rows, an issuer's account for its parent defaults
+ *
+ * Token attributes packed as tag-length-value entries, `uint8 tag, uint8 length, value`,
+ * in ascending tag order. A row keyed by `pid` in the scope of an issuer holds defaults
+ * that the tokens of that issuer under `pid` inherit for every tag they do not set
+ * themselves, so no other account can change what a collection inherits.
+ */
+TBL attr_t {
+    uint64_t        key;            //PK: token id, or parent id in an issuer's scope
+    vector<char>    tlv;
+
+    static constexpr size_t MAX_VALUE_SIZE = 255;
+
+    attr_t() {}
+
+    uint64_t primary_key()const { return key; }
+
+    /// offset of the first entry in `tlv[0, size)` whose tag is not below `tag`, or `size`
+    static size_t lower(const char* tlv, const size_t& size, const uint8_t& tag) {
+        size_t pos = 0;
+        while ( pos + 2 <= size && (uint8_t)tlv[pos] < tag )
+            pos += 2 + (uint8_t)tlv[pos + 1];
+        return std::min( pos, size );
+    }
+
+    void set(const uint8_t& tag, const vector<char>& value) {
+        auto pos = lower( tlv.data(), tlv.size(), tag );
+        if ( pos < tlv.size() && (uint8_t)tlv[pos] == tag )
+            tlv.erase( tlv.begin() + pos, tlv.begin() + pos + 2 + (uint8_t)tlv[pos + 1] );
+        if ( value.empty() ) return;
+
+        char head[2] = { (char)tag, (char)value.size() };
+        tlv.insert( tlv.begin() + pos, value.begin(), value.end() );
+        tlv.insert( tlv.begin() + pos, head, head + 2 );
+    }
+
+    EOSLIB_SERIALIZE(attr_t, (key)(tlv) )
+
+    typedef eosio::multi_index< "attrs"_n, attr_t > idx_t;
+};
+
+///Scope: self, a parent id whose whole collection is frozen: no issue or transfer of its tokens
+TBL pause_t {
+    uint32_t        pid;            //PK
+    time_point_sec  paused_at;
+
+    pause_t() {}
+
+    uint64_t primary_key()const { return pid; }
+
+    EOSLIB_SERIALIZE(pause_t, (pid)(paused_at) )
+
+    typedef eosio::multi_index< "pauses"_n, pause_t > idx_t;
+};
+
 ///Scope: owner's account
 TBL account_t {
     nasset      balance;            //PK: symbol
@@ -138,4 +375,21 @@ TBL account_t {
     typedef eosio::multi_index< "accounts"_n, account_t > idx_t;
 };
 
+///Scope: owner's account
+TBL approval_t {
+    name                op;             //PK: operator allowed to transfer the owner's assets
+    vector<uint64_t>    symbols;        // sorted nsymbol raws, empty means all symbols
+
+    approval_t() {}
+
+    uint64_t primary_key()const { return op.value; }
+    bool allows(const nsymbol& sym)const {
+        return symbols.empty() || std::binary_search( symbols.begin(), symbols.end(), sym.raw() );
+    }
+
+    EOSLIB_SERIALIZE(approval_t, (op)(symbols) )
+
+    typedef eosio::multi_index< "approvals"_n, approval_t > idx_t;
+};
+
 } //namespace flon
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <string>
 
 #include <flon.ntoken/flon.ntoken.db.hpp>
+#include <flon.ntoken/table_cache.hpp>
 
 namespace flon {
 
@@ -33,15 +34,32 @@ class [[eosio::contract("flon.ntoken")]] ntoken : public contract {
       using contract::contract;
 
    ntoken(eosio::name receiver, eosio::name code, datastream<const char*> ds): contract(receiver, code, ds),
-        _global(get_self(), get_self().value)
+        _global(get_self(), get_self().value),
+        _global_stats(get_self(), get_self().value),
+        _global_shard(get_self(), get_self().value)
     {
         _gstate = _global.exists() ? _global.get() : global_t{};
+        _shardconf = _global_shard.exists() ? _global_shard.get() : shardconf_t{};
+        _shardconf_saved = _shardconf;
+        if ( _global_stats.exists() ) {
+           _gstats        = _global_stats.get();
+           _gstats_saved  = _gstats;
+        } else if ( !_shardconf.sharded() && _nstats().begin() == _nstats().end() && _series().begin() == _series().end() ) {
+           // nothing to backfill: count every row live from the start
+           _gstats.token_cursor = MAX_TOKEN_CURSOR;
+           _gstats.owner_cursor = MAX_OWNER_CURSOR;
+        }
     }
 
     ~ntoken() { 
       _global.set( _gstate, get_self() ); 
+      if ( _gstats_saved != _gstats ) _global_stats.set( _gstats, get_self() );
+      if ( _shardconf_saved != _shardconf ) _global_shard.set( _shardconf, get_self() );
    }
 
+   // Every ACTION below other than transfer, issue and retire must also be listed in
+   // NTOKEN_EXECUTED_ACTIONS at the end of this file, or the custom `apply` rejects it.
+
    /**
     * @brief Allows `issuer` account to create a token in supply of `maximum_supply`. If validation is successful a new entry in statsta
     *
@@ -51,6 +69,23 @@ class [[eosio::contract("flon.ntoken")]] ntoken : public contract {
     */
    ACTION create( const name& issuer, const int64_t& maximum_supply, const nsymbol& symbol, const string& token_uri, const name& ipowner );
 
+   /**
+    * @brief Allows `issuer` to create a series of tokens with ids `[first_id, last_id]` under parent `pid`,
+    *        described by a single row instead of one `tokenstats` row per id.
+    *
+    * @param issuer  - the account that creates the series
+    * @param pid - parent id shared by every token of the series
+    * @param first_id - first token id of the range
+    * @param last_id - last token id of the range, inclusive
+    * @param maximum_supply - the maximum supply of each token id
+    * @param uri_base - token uri of each id is `uri_base` followed by the id. Unique among series,
+    *                   but the per-id uris are not checked against other tokens, see `series_t`
+    * @param ipowner - who owns the IP
+    * @return ACTION
+    */
+   ACTION createseries( const name& issuer, const uint32_t& pid, const uint32_t& first_id, const uint32_t& last_id,
+                        const int64_t& maximum_supply, const string& uri_base, const name& ipowner );
+
    /**
     * @brief This action issues to `to` account a `quantity` of tokens.
     *
@@ -77,6 +112,64 @@ class [[eosio::contract("flon.ntoken")]] ntoken : public contract {
    ACTION transfer( const name& from, const name& to, const vector<nasset>& assets, const string& memo );
    using transfer_action = action_wrapper< "transfer"_n, &ntoken::transfer >;
 
+   /**
+    * @brief Same as `transfer`, with the assets in a compact encoding to save NET bandwidth.
+    *
+    * All assets share one parent id and are listed in ascending id order:
+    *
+    *    uint8     flags       bit 0 set: every amount is 1, bitmap and amounts are omitted
+    *    varuint   pid
+    *    varuint   count
+    *    varuint   id[count]   first id, then the delta to the previous id
+    *    bytes     bitmap      (count + 7) / 8 bytes, bit i set when amount i is 1
+    *    varuint   amount[]    for each asset whose bitmap bit is clear
+    *
+    * varuint is the LEB128 encoding also used for ABI lengths.
+    *
+    * @param from is account who sends the assets.
+    * @param to is account of receiver.
+    * @param packed is the encoded assets.
+    * @param memo is transfers comment.
+    * @return no return value.
+    */
+   ACTION transferpk( const name& from, const name& to, const vector<char>& packed, const string& memo );
+
+   /**
+    * @brief Transfers assets from one sender to many recipients.
+    *
+    * The sender is debited once per symbol for the total and each recipient is credited
+    * once per symbol. RAM of new balance rows is charged as in `transfer`.
+    *
+    * @param from is account who sends the assets.
+    * @param recipients is list of receivers with the assets each one gets.
+    * @param memo is transfers comment.
+    * @return no return value.
+    */
+   ACTION transfermany( const name& from, const vector<nrecipient>& recipients, const string& memo );
+
+   /**
+    * @brief `owner` approves or revokes `op` as operator of its assets
+    *
+    * @param owner - the account whose assets `op` may transfer
+    * @param op - the operator, e.g. a marketplace contract
+    * @param symbols - symbols covered, empty means all symbols
+    * @param approved - true to grant, false to revoke the given symbols (or the whole approval when empty)
+    * @return ACTION
+    */
+   ACTION approve( const name& owner, const name& op, const vector<nsymbol>& symbols, const bool& approved );
+
+   /**
+    * @brief settles a batch of transfers on behalf of their senders, each of which must have approved `op`.
+    *        Balances are netted per account and symbol, so each balance row is written at most once,
+    *        but each sender must hold its gross amount sent: assets received in the batch cannot be relayed.
+    *
+    * @param op - the approved operator, pays RAM of new balance rows
+    * @param transfers - list of `from`, `to` and `quantity`
+    * @param memo - transfers comment
+    * @return ACTION
+    */
+   ACTION transferfrom( const name& op, const vector<ntransfer>& transfers, const string& memo );
+
    /**
     * @brief fragment a NFT into multiple common or unique NFT pieces
     *
@@ -97,9 +190,113 @@ class [[eosio::contract("flon.ntoken")]] ntoken : public contract {
     * @return ACTION
     */
    ACTION notarize(const name& notary, const uint32_t& token_id);
+
+   /**
+    * @brief notary to notarize many NFT assets at once, skipping those it already notarized.
+    *        Notarization is kept per id in `tokenstats`, so each series id not yet materialized
+    *        gets its own row, paid by the notary: certifying a whole series costs one full
+    *        `tokenstats` row per id, as if it had been created token by token.
+    *
+    * @param notary
+    * @param token_ids
+    * @return ACTION
+    */
+   ACTION notarizebatch(const name& notary, const vector<uint32_t>& token_ids);
+
+   /**
+    * @brief freeze or unfreeze every token under parent `pid` with a single row
+    *
+    * @param pid - parent id of the collection
+    * @param paused - true to freeze, false to unfreeze
+    * @return ACTION
+    */
+   ACTION pausepid(const uint32_t& pid, const bool& paused);
    ACTION setcreator( const name& creator, const bool& to_add);
 
+   /**
+    * @brief set or remove attributes of tokens, or the defaults of a parent id.
+    *        Each token must be issued by `issuer`. Parent defaults are kept per issuer and only
+    *        inherited by that issuer's own tokens under the parent; parent id 0 takes no defaults.
+    *
+    * @param issuer - pays RAM of the attribute rows
+    * @param attrs - per token or parent, list of `tag` and `value`, an empty value removes the tag
+    */
+   ACTION setattrs( const name& issuer, const vector<nattrs>& attrs );
+
+   /**
+    * @brief backfill the `gstats` aggregates with rows created before they were tracked.
+    *        First walks `tokenstats` in chunks of `max_rows` (owners must be empty), then counts
+    *        the `accounts` scopes passed in `owners`, which must be strictly ascending across calls.
+    *        An empty `owners` list after the token walk marks the backfill as complete.
+    *        Not needed when the first `gstats` row was written on a contract without tokens.
+    *
+    * @param max_rows - upper bound of rows to read in this call
+    * @param owners - next owner scopes to count, e.g. from `get_table_by_scope`
+    */
+   ACTION initstats( const uint32_t& max_rows, const vector<name>& owners );
+
+   /**
+    * @brief shard `tokenstats` by id ranges of `shard_size` ids. Can only be set once.
+    *        Existing rows stay readable in place until moved by `migrateshard`.
+    *
+    * @param shard_size - number of token ids per shard scope
+    */
+   ACTION setsharding( const uint32_t& shard_size );
+
+   /**
+    * @brief move up to `max_rows` `tokenstats` rows from the contract scope into their shards.
+    *        The moved rows are paid by the contract, which releases the RAM their issuers paid for.
+    *
+    * @param max_rows - upper bound of rows to move in this call
+    */
+   ACTION migrateshard( const uint32_t& max_rows );
+
+   static gstats_t get_stats( const name& contract ) {
+      auto gstats = gstats_singleton( contract, contract.value );
+      return gstats.get_or_default();
+   }
+
+   /**
+    * @brief stats of a token id, synthesized from its series when no `tokenstats` row was materialized
+    */
+   static nstats_t get_token( const name& contract, const uint32_t& id ) {
+      auto conf = shardconf_singleton( contract, contract.value ).get_or_default();
+      if ( conf.sharded() ) {
+         auto shard = flon::nstats_t::idx_t( contract, conf.scope(id) );
+         auto itr = shard.find( id );
+         if ( itr != shard.end() ) return *itr;
+      }
+      if ( !conf.migrated ) {
+         auto nstats = flon::nstats_t::idx_t( contract, contract.value );
+         auto itr = nstats.find( id );
+         if ( itr != nstats.end() ) return *itr;
+      }
+
+      auto series = flon::series_t::idx_t( contract, contract.value );
+      auto s = find_series( series, id );
+      check( s != series.end(), "token not found" );
+
+      nstats_t st;
+      st.supply         = nasset( s->supply(id), s->symbol(id) );
+      st.max_supply     = nasset( s->max_supply, s->symbol(id) );
+      st.token_uri      = s->token_uri(id);
+      st.ipowner        = s->ipowner;
+      st.issuer         = s->issuer;
+      st.issued_at      = s->created_at;
+      st.paused         = false;
+      return st;
+   }
+
+   /// the series range holding `id`, or `series.end()`
+   static series_t::idx_t::const_iterator find_series( const series_t::idx_t& series, const uint32_t& id ) {
+      auto itr = series.lower_bound( id );
+      return ( itr != series.end() && itr->first_id <= id ) ? itr : series.end();
+   }
+
    static nasset get_balance(const name& contract, const name& owner, const nsymbol& sym) { 
+      auto pauses = flon::pause_t::idx_t( contract, contract.value );
+      if ( pauses.find( sym.pid ) != pauses.end() ) return nasset( 0, sym );
+
       auto acnts = flon::account_t::idx_t( contract, owner.value ); 
       const auto& acnt = acnts.get( sym.raw(), "no balance object found" ); 
       return acnt.paused? 0 : acnt.balance; 
@@ -122,13 +319,103 @@ class [[eosio::contract("flon.ntoken")]] ntoken : public contract {
       return amount; 
    }
 
+   /**
+    * @brief value of attribute `tag` of token `id`, inherited from the defaults its issuer set for the
+    *        token's parent when the token does not set it; empty when neither does.
+    *        Scans the raw row bytes without unpacking the attribute blob.
+    */
+   static vector<char> get_attr( const name& contract, const uint32_t& id, const uint8_t& tag ) {
+      vector<char> value;
+      if ( !read_attr( contract, contract, id, tag, value ) ) {
+         auto token = get_token( contract, id );
+         if ( token.supply.symbol.pid != 0 )
+            read_attr( contract, token.issuer, token.supply.symbol.pid, tag, value );
+      }
+      return value;
+   }
+
+   static bool read_attr( const name& contract, const name& scope, const uint64_t& key, const uint8_t& tag, vector<char>& value ) {
+      auto itr = internal_use_do_not_use::db_find_i64( contract.value, scope.value, "attrs"_n.value, key );
+      if ( itr < 0 ) return false;
+
+      auto size = internal_use_do_not_use::db_get_i64( itr, nullptr, 0 );
+      vector<char> row( size );
+      internal_use_do_not_use::db_get_i64( itr, row.data(), size );
+
+      datastream<const char*> ds( row.data(), row.size() );
+      uint64_t row_key;
+      unsigned_int len;
+      ds >> row_key >> len;
+      const char* tlv = ds.pos();
+      auto pos = attr_t::lower( tlv, len.value, tag );
+      if ( pos == len.value || (uint8_t)tlv[pos] != tag ) return false;
+
+      value.assign( tlv + pos + 2, tlv + pos + 2 + (uint8_t)tlv[pos + 1] );
+      return true;
+   }
+
+#ifdef NTOKEN_CUSTOM_DISPATCH
+   /**
+    * @brief entry of `transfer`, `issue` and `retire` for the custom `apply`, reading their assets
+    *        and memo length in place from the action data; returns false for any other action
+    */
+   static bool fast_dispatch( const name& receiver, const name& code, const name& action );
+#endif
+
    private:
       void add_balance( const name& owner, const nasset& value, const name& ram_payer );
-      void sub_balance( const name& owner, const nasset& value );
+      void sub_balance( const name& owner, const nasset& value, const bool& owner_pays = true );
+      void _count_balance_row( const name& owner, const account_t::idx_t& acnts );
       void _creator_auth_check( const name& creator);
+      template<typename Assets>
+      void _transfer( const name& from, const name& to, const Assets& assets, const size_t& memo_size );
+      void _issue( const name& to, const nasset& quantity, const size_t& memo_size );
+      void _retire( const nasset& quantity, const size_t& memo_size );
+      nsymbol _token_symbol( const uint32_t& id );
+      name _token_issuer( const uint32_t& id );
+      void _check_not_paused( const nsymbol& sym );
+      nstats_t::idx_t::const_iterator _materialize( nstats_t::idx_t& nstats, const uint32_t& id, const name& ram_payer );
+      bool _stats_tracked( const uint32_t& id );
+      nstats_t::idx_t& _stats_table( const uint32_t& id );
+      bool _token_in_range( const uint32_t& first_id, const uint32_t& last_id );
+      void _check_token_uri( const string& token_uri );
+      void _register_token_uri( const string& token_uri, const uint32_t& id, const name& ram_payer );
+      void _unregister_token_uri( const string& token_uri, const uint32_t& id );
+
+      nstats_t::idx_t& _nstats()                            { return _stats_tables.get( _self, _self.value ); }
+      series_t::idx_t& _series()                            { return _series_tables.get( _self, _self.value ); }
+      account_t::idx_t& _accounts( const name& owner )      { return _acnt_tables.get( _self, owner.value ); }
+      approval_t::idx_t& _approvals( const name& owner )    { return _approval_tables.get( _self, owner.value ); }
+      tokenuri_t::idx_t& _tokenuris()                       { return _tokenuri_tables.get( _self, _self.value ); }
+      pause_t::idx_t& _pauses()                             { return _pause_tables.get( _self, _self.value ); }
+      attr_t::idx_t& _attrs( const name& scope )            { return _attr_tables.get( _self, scope.value ); }
 
    private:
       global_singleton     _global;
       global_t             _gstate;
+      gstats_singleton     _global_stats;
+      gstats_t             _gstats;
+      std::optional<gstats_t> _gstats_saved;   // as loaded, nullopt when the row does not exist yet
+      shardconf_singleton  _global_shard;
+      shardconf_t          _shardconf;
+      shardconf_t          _shardconf_saved;    // as loaded, a missing row stays missing until sharding is set
+      table_cache<nstats_t>      _stats_tables;
+      table_cache<series_t>      _series_tables;
+      table_cache<account_t>     _acnt_tables;
+      table_cache<approval_t>    _approval_tables;
+      table_cache<tokenuri_t>    _tokenuri_tables;
+      table_cache<pause_t>       _pause_tables;
+      table_cache<attr_t>        _attr_tables;
 };
+
+/**
+ * The actions the custom `apply` (NTOKEN_CUSTOM_DISPATCH) hands to `execute_action`: every
+ * `ACTION` of `ntoken` except `transfer`, `issue` and `retire`, which it decodes itself.
+ * The dispatch tests push every ABI action to that build and fail on one missing here.
+ */
+#define NTOKEN_EXECUTED_ACTIONS( X ) \
+   X(create) X(createseries) X(transferpk) X(transfermany) X(approve) X(transferfrom) \
+   X(setnotary) X(setipowner) X(settokenuri) X(notarize) X(notarizebatch) X(pausepid) \
+   X(setcreator) X(setattrs) X(initstats) X(setsharding) X(migrateshard)
+
 } //namespace flon
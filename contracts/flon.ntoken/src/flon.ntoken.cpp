@@ -15,20 +15,35 @@ void ntoken::create( const name& issuer, const int64_t& maximum_supply, const ns
    _creator_auth_check( issuer );
 
    auto nsymb           = symbol;
-   auto nstats          = nstats_t::idx_t( _self, _self.value );
-   auto idx             = nstats.get_index<"tokenuriidx"_n>();
-   auto token_uri_hash  = HASH256(token_uri);
-   // auto lower_itr = idx.lower_bound( token_uri_hash );
-   // auto upper_itr = idx.upper_bound( token_uri_hash );
-   // check( lower_itr == idx.end() || lower_itr == upper_itr, "token with token_uri already exists" );
-   check( idx.find(token_uri_hash) == idx.end(), "token with token_uri already exists" );
-   check( nstats.find(nsymb.id) == nstats.end(), "token of ID: " + to_string(nsymb.id) + " alreay exists" );
-   if (nsymb.id != 0)
+   auto& series         = _series();
+   auto parents         = series.get_index<"parentidx"_n>();
+   _check_token_uri( token_uri );
+   if (nsymb.id != 0) {
       check( nsymb.id != nsymb.pid, "parent id shall not be equal to id" );
-   else
-      nsymb.id         = nstats.available_primary_key();
 
-   nstats.emplace( issuer, [&]( auto& s ) {
+   } else {
+      nsymb.id         = _shardconf.sharded() ? _shardconf.next_id : _nstats().available_primary_key();
+      // the primary key does not see series, so skip past any range or series parent the id lands on
+      for( auto s = find_series( series, nsymb.id ); ; s = find_series( series, nsymb.id ) ) {
+         if ( s != series.end() )
+            nsymb.id   = s->last_id + 1;
+         else if ( parents.find( nsymb.id ) != parents.end() )
+            nsymb.id++;
+         else
+            break;
+      }
+   }
+
+   auto& nstats         = _stats_table( nsymb.id );
+   CHECK( nstats.find(nsymb.id) == nstats.end(), "token of ID: " + to_string(nsymb.id) + " alreay exists" );
+   CHECK( find_series( series, nsymb.id ) == series.end(), "token of ID: " + to_string(nsymb.id) + " belongs to a series" );
+   CHECK( parents.find( nsymb.id ) == parents.end(), "token of ID: " + to_string(nsymb.id) + " is the parent of a series" );
+
+   if ( _gstats.has_token(nsymb.id) ) _gstats.tokens++;
+   if ( _shardconf.sharded() ) _shardconf.next_id = std::max( _shardconf.next_id, nsymb.id + 1 );
+   _register_token_uri( token_uri, nsymb.id, issuer );
+
+   _stats_table( nsymb.id ).emplace( issuer, [&]( auto& s ) {
       s.supply.symbol   = nsymb;
       s.max_supply      = nasset( maximum_supply, symbol );
       s.token_uri       = token_uri;
@@ -38,11 +53,50 @@ void ntoken::create( const name& issuer, const int64_t& maximum_supply, const ns
    });
 }
 
+void ntoken::createseries( const name& issuer, const uint32_t& pid, const uint32_t& first_id, const uint32_t& last_id,
+                           const int64_t& maximum_supply, const string& uri_base, const name& ipowner )
+{
+   require_auth( issuer );
+
+   check( is_account(issuer), "issuer account does not exist" );
+   check( is_account(ipowner) || ipowner.length() == 0, "ipowner account does not exist" );
+   check( maximum_supply > 0, "max-supply must be positive" );
+   check( uri_base.length() < 1024, "uri base length > 1024" );
+   check( first_id > 0 && first_id <= last_id, "invalid series range" );
+   check( pid < first_id || pid > last_id, "parent id shall not be inside the series" );
+   check( last_id < U1E9 && pid < U1E9, "ids must be below 10**9" );
+
+   _creator_auth_check( issuer );
+
+   auto& series         = _series();
+   auto next            = series.lower_bound( first_id );
+   check( next == series.end() || next->first_id > last_id, "series overlaps an existing series" );
+
+   check( !_token_in_range( first_id, last_id ), "series overlaps existing tokens" );
+
+   auto uri_bases       = series.get_index<"uribaseidx"_n>();
+   check( uri_bases.find( HASH256(uri_base) ) == uri_bases.end(), "series with uri_base already exists" );
+
+   series.emplace( issuer, [&]( auto& s ) {
+      s.last_id         = last_id;
+      s.first_id        = first_id;
+      s.pid             = pid;
+      s.max_supply      = maximum_supply;
+      s.uri_base        = uri_base;
+      s.ipowner         = ipowner;
+      s.issuer          = issuer;
+      s.created_at      = current_time_point();
+   });
+
+   // series are always counted live, `initstats` skips their rows
+   _gstats.tokens += last_id - first_id + 1;
+}
+
 void ntoken::setipowner(const uint64_t& symbid, const name& ip_owner) {
    check( has_auth( _self ) || has_auth( "armoniaadmin"_n), "no auth" );
 
-   auto nstats          = nstats_t::idx_t( _self, _self.value );
-   auto itr             = nstats.find( symbid );
+   auto& nstats         = _stats_table( symbid );
+   auto itr             = _materialize( nstats, symbid, _self );
    check( itr != nstats.end(), "nft not found" );
 
    nstats.modify( itr, same_payer, [&](auto& row){
@@ -53,10 +107,13 @@ void ntoken::setipowner(const uint64_t& symbid, const name& ip_owner) {
 void ntoken::settokenuri(const uint64_t& symbid, const string& url) {
    check( has_auth("armoniaadmin"_n) || has_auth( "nftone.admin"_n ) || has_auth(_self), "non authorized" );
 
-   auto nstats          = nstats_t::idx_t( _self, _self.value );
-   auto itr             = nstats.find( symbid );
+   auto& nstats         = _stats_table( symbid );
+   auto itr             = _materialize( nstats, symbid, _self );
    check( itr != nstats.end(), "nft not found" );
 
+   _unregister_token_uri( itr->token_uri, symbid );
+   _register_token_uri( url, symbid, _self );
+
    nstats.modify( itr, same_payer, [&](auto& row){
       row.token_uri     = url;
    });
@@ -65,34 +122,111 @@ void ntoken::setnotary(const name& notary, const bool& to_add) {
    require_auth( _self );
 
    if (to_add)
-      _gstate.notaries.insert(notary);
+      global_t::insert( _gstate.notaries, notary );
 
    else
-      _gstate.notaries.erase(notary);
+      global_t::erase( _gstate.notaries, notary );
 
 }
 
 void ntoken::notarize(const name& notary, const uint32_t& token_id) {
    require_auth( notary );
-   check( _gstate.notaries.find(notary) != _gstate.notaries.end(), "not authorized notary" );
+   check( global_t::contains( _gstate.notaries, notary ), "not authorized notary" );
+
+   auto& nstats = _stats_table( token_id );
+   auto itr = _materialize( nstats, token_id, notary );
+   CHECK( itr != nstats.end(), "token not found: " + to_string(token_id) );
+   if ( itr->notary.value == 0 && _stats_tracked(token_id) ) _gstats.notarized++;
 
-   auto nstats = nstats_t::idx_t( _self, _self.value );
-   auto itr = nstats.find( token_id );
-   check( itr != nstats.end(), "token not found: " + to_string(token_id) );
    nstats.modify( itr, same_payer, [&]( auto& row ) {
       row.notary = notary;
       row.notarized_at = time_point_sec( current_time_point()  );
     });
 }
 
+void ntoken::notarizebatch(const name& notary, const vector<uint32_t>& token_ids) {
+   require_auth( notary );
+   check( global_t::contains( _gstate.notaries, notary ), "not authorized notary" );
+   check( token_ids.size() > 0, "no token ids" );
+
+   auto now = time_point_sec( current_time_point() );
+   // series ids are materialized one by one, see the RAM note at the declaration
+   for( auto& id : token_ids ) {
+      auto& nstats = _stats_table( id );
+      auto itr = _materialize( nstats, id, notary );
+      CHECK( itr != nstats.end(), "token not found: " + to_string(id) );
+      if ( itr->notary == notary ) continue;
+      if ( itr->notary.value == 0 && _stats_tracked(id) ) _gstats.notarized++;
+
+      nstats.modify( itr, same_payer, [&]( auto& row ) {
+         row.notary = notary;
+         row.notarized_at = now;
+      });
+   }
+}
+
+void ntoken::pausepid(const uint32_t& pid, const bool& paused) {
+   require_auth( _self );
+
+   auto& pauses = _pauses();
+   auto itr = pauses.find( pid );
+   if ( paused ) {
+      CHECK( itr == pauses.end(), "parent already paused: " + to_string(pid) );
+      pauses.emplace( _self, [&]( auto& p ) {
+         p.pid       = pid;
+         p.paused_at = current_time_point();
+      });
+   } else {
+      CHECK( itr != pauses.end(), "parent not paused: " + to_string(pid) );
+      pauses.erase( itr );
+   }
+}
+
+void ntoken::_check_not_paused( const nsymbol& sym ) {
+   auto& pauses = _pauses();
+   CHECK( pauses.find( sym.pid ) == pauses.end(), "token parent is paused: " + to_string(sym.pid) );
+}
+
 void ntoken::issue( const name& to, const nasset& quantity, const string& memo )
+{
+    _issue( to, quantity, memo.size() );
+}
+
+void ntoken::_issue( const name& to, const nasset& quantity, const size_t& memo_size )
 {
     auto sym = quantity.symbol;
    //  check( sym.is_valid(), "invalid symbol name" );
-    check( memo.size() <= 256, "memo has more than 256 bytes" );
+    check( memo_size <= 256, "memo has more than 256 bytes" );
+
+    _check_not_paused( sym );
 
-    auto nstats = nstats_t::idx_t( _self, _self.value );
+    auto& nstats = _stats_table( sym.id );
     auto existing = nstats.find( sym.id );
+
+    auto& series = _series();
+    auto s = find_series( series, sym.id );
+    if ( s != series.end() && sym.id - s->first_id >= s->minted ) {
+      check( to == s->issuer, "tokens can only be issued to issuer account" );
+      require_auth( s->issuer );
+      check( quantity.symbol == s->symbol(sym.id), "symbol mismatch" );
+      CHECK( sym.id == s->first_id + s->minted, "series tokens are issued in id order, next: " + to_string(s->first_id + s->minted) );
+      check( quantity.amount == s->max_supply, "series tokens are issued in full max supply" );
+
+      series.modify( s, same_payer, [&]( auto& row ) {
+         row.minted++;
+      });
+      if ( existing != nstats.end() ) {
+         nstats.modify( existing, same_payer, [&]( auto& row ) {
+            row.supply += quantity;
+            row.issued_at = current_time_point();
+         });
+      }
+      _gstats.supply += quantity.amount;
+
+      add_balance( s->issuer, quantity, s->issuer );
+      return;
+    }
+
     check( existing != nstats.end(), "token with symbol does not exist, create token before issue" );
     const auto& st = *existing;
     check( to == st.issuer, "tokens can only be issued to issuer account" );
@@ -108,22 +242,29 @@ void ntoken::issue( const name& to, const nasset& quantity, const string& memo )
       s.supply += quantity;
       s.issued_at = current_time_point();
     });
+    if ( _stats_tracked(sym.id) ) _gstats.supply += quantity.amount;
 
     add_balance( st.issuer, quantity, st.issuer );
 }
 
 void ntoken::retire( const nasset& quantity, const string& memo )
+{
+    _retire( quantity, memo.size() );
+}
+
+void ntoken::_retire( const nasset& quantity, const size_t& memo_size )
 {
     auto sym = quantity.symbol;
    //  check( sym.is_valid(), "invalid symbol name" );
-    check( memo.size() <= 256, "memo has more than 256 bytes" );
+    check( memo_size <= 256, "memo has more than 256 bytes" );
 
-    auto nstats = nstats_t::idx_t( _self, _self.value );
-    auto existing = nstats.find( sym.id );
+    auto issuer = _token_issuer( sym.id );
+    require_auth( issuer );
+
+    auto& nstats = _stats_table( sym.id );
+    auto existing = _materialize( nstats, sym.id, issuer );
     check( existing != nstats.end(), "token with symbol does not exist" );
     const auto& st = *existing;
-
-    require_auth( st.issuer );
    //  check( quantity.is_valid(), "invalid quantity" );
     check( quantity.amount > 0, "must retire positive quantity" );
 
@@ -132,29 +273,94 @@ void ntoken::retire( const nasset& quantity, const string& memo )
     nstats.modify( st, same_payer, [&]( auto& s ) {
        s.supply -= quantity;
     });
+    if ( _stats_tracked(sym.id) ) _gstats.supply -= quantity.amount;
 
     sub_balance( st.issuer, quantity );
 }
 
 void ntoken::transfer( const name& from, const name& to, const vector<nasset>& assets, const string& memo  )
+{
+   _transfer( from, to, assets, memo.size() );
+}
+
+/// reads the `transferpk` encoding, see its declaration
+static vector<nasset> unpack_nassets( const vector<char>& packed ) {
+   auto pos = packed.data();
+   auto end = pos + packed.size();
+
+   auto read_byte = [&]() -> uint8_t {
+      check( pos < end, "packed assets truncated" );
+      return (uint8_t) *pos++;
+   };
+   auto read_varuint = [&]() -> uint64_t {
+      uint64_t value = 0;
+      for( uint8_t shift = 0; ; shift += 7 ) {
+         check( shift < 64, "packed varuint overflow" );
+         auto b = read_byte();
+         value |= uint64_t( b & 0x7f ) << shift;
+         if ( !( b & 0x80 ) ) return value;
+      }
+   };
+
+   auto flags = read_byte();
+   check( !(flags & ~0x01), "unknown packed flags" );
+   auto pid   = read_varuint();
+   auto count = read_varuint();
+   check( pid < U1E9, "pid must be below 10**9" );
+   check( count > 0 && count <= packed.size(), "invalid packed asset count" );
+
+   vector<nasset> assets( count );
+   uint64_t id = 0;
+   for( uint64_t i = 0; i < count; i++ ) {
+      auto delta = read_varuint();
+      check( i == 0 || delta > 0, "packed ids must be ascending" );
+      check( delta < U1E9 - id, "id must be below 10**9" );
+      id += delta;
+      assets[i].symbol = nsymbol( (uint32_t) id, (uint32_t) pid );
+      assets[i].amount = 1;
+   }
+
+   if ( flags & 0x01 ) {
+      check( pos == end, "unexpected bytes after packed assets" );
+      return assets;
+   }
+
+   auto bitmap = pos;
+   pos += ( count + 7 ) / 8;
+   check( pos <= end, "packed assets truncated" );
+   for( uint64_t i = 0; i < count; i++ ) {
+      if ( bitmap[i / 8] & ( 1 << ( i % 8 ) ) ) continue;
+
+      auto amount = read_varuint();
+      check( amount <= (uint64_t) std::numeric_limits<int64_t>::max(), "packed amount overflow" );
+      assets[i].amount = (int64_t) amount;
+   }
+   check( pos == end, "unexpected bytes after packed assets" );
+   return assets;
+}
+
+void ntoken::transferpk( const name& from, const name& to, const vector<char>& packed, const string& memo )
+{
+   _transfer( from, to, unpack_nassets( packed ), memo.size() );
+}
+
+template<typename Assets>
+void ntoken::_transfer( const name& from, const name& to, const Assets& assets, const size_t& memo_size )
 {
    check( from != to, "cannot transfer to self" );
    require_auth( from );
    check( is_account( to ), "to account does not exist");
-   check( memo.size() <= 256, "memo has more than 256 bytes" );
+   check( memo_size <= 256, "memo has more than 256 bytes" );
    auto payer = has_auth( to ) ? to : from;
 
    require_recipient( from );
    require_recipient( to );
 
-   for( auto& quantity : assets) {
-      auto sym = quantity.symbol;
-      auto nstats = nstats_t::idx_t( _self, _self.value );
-      const auto& st = nstats.get( sym.id );
-
+   for( const auto& quantity : assets) {
       // check( quantity.is_valid(), "invalid quantity" );
       check( quantity.amount > 0, "must transfer positive quantity" );
-      check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+      check( quantity.symbol == _token_symbol( quantity.symbol.id ), "symbol precision mismatch" );
+      _check_not_paused( quantity.symbol );
 
       sub_balance( from, quantity );
       add_balance( to, quantity, payer );
@@ -163,22 +369,333 @@ void ntoken::transfer( const name& from, const name& to, const vector<nasset>& a
 }
 
 
-void ntoken::sub_balance( const name& owner, const nasset& value ) {
-   auto from_acnts = account_t::idx_t( get_self(), owner.value );
+void ntoken::transfermany( const name& from, const vector<nrecipient>& recipients, const string& memo )
+{
+   require_auth( from );
+   check( recipients.size() > 0, "no recipients" );
+   check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+   require_recipient( from );
+
+   map<uint64_t, nasset>                  debits;        // total per symbol
+   map<pair<name, uint64_t>, nasset>      credits;       // total per (recipient, symbol)
+   set<name>                              receivers;
+
+   for( auto& recipient : recipients ) {
+      auto& to = recipient.to;
+      check( from != to, "cannot transfer to self" );
+      if ( receivers.insert( to ).second ) {
+         check( is_account( to ), "to account does not exist");
+         require_recipient( to );
+      }
+
+      for( auto& quantity : recipient.assets ) {
+         check( quantity.amount > 0, "must transfer positive quantity" );
+
+         auto sym = quantity.symbol.raw();
+         auto debit = debits.find( sym );
+         if ( debit == debits.end() ) {
+            check( quantity.symbol == _token_symbol( quantity.symbol.id ), "symbol precision mismatch" );
+            _check_not_paused( quantity.symbol );
+            debit = debits.emplace( sym, nasset( 0, quantity.symbol ) ).first;
+         }
+         // each credit is part of its debit, so bounding the debit keeps both from wrapping
+         check( quantity.amount <= std::numeric_limits<int64_t>::max() - debit->second.amount, "transfer amount overflow" );
+         debit->second += quantity;
+
+         auto credit = credits.emplace( make_pair( to, sym ), nasset( 0, quantity.symbol ) ).first;
+         credit->second += quantity;
+      }
+   }
+
+   for( auto& [ sym, quantity ] : debits )
+      sub_balance( from, quantity );
+
+   for( auto& [ key, quantity ] : credits ) {
+      auto payer = has_auth( key.first ) ? key.first : from;
+      add_balance( key.first, quantity, payer );
+   }
+}
+
+nsymbol ntoken::_token_symbol( const uint32_t& id ) {
+   auto& nstats = _stats_table( id );
+   auto itr = nstats.find( id );
+   if ( itr != nstats.end() ) return itr->supply.symbol;
+
+   auto& series = _series();
+   auto s = find_series( series, id );
+   CHECK( s != series.end(), "token not found: " + to_string(id) );
+   return s->symbol(id);
+}
+
+name ntoken::_token_issuer( const uint32_t& id ) {
+   auto& nstats = _stats_table( id );
+   auto itr = nstats.find( id );
+   if ( itr != nstats.end() ) return itr->issuer;
+
+   auto& series = _series();
+   auto s = find_series( series, id );
+   CHECK( s != series.end(), "token not found: " + to_string(id) );
+   return s->issuer;
+}
+
+/**
+ * Returns the `tokenstats` row of `id`, creating it from the series range holding `id`
+ * when it has not been materialized yet, or `nstats.end()` if the token does not exist.
+ * A new row is paid by `ram_payer`, the account authorizing the action that needs it.
+ */
+nstats_t::idx_t::const_iterator ntoken::_materialize( nstats_t::idx_t& nstats, const uint32_t& id, const name& ram_payer ) {
+   auto itr = nstats.find( id );
+   if ( itr != nstats.end() ) return itr;
+
+   auto& series = _series();
+   auto s = find_series( series, id );
+   if ( s == series.end() ) return itr;
+
+   return nstats.emplace( ram_payer, [&]( auto& row ) {
+      row.supply        = nasset( s->supply(id), s->symbol(id) );
+      row.max_supply    = nasset( s->max_supply, s->symbol(id) );
+      row.token_uri     = s->token_uri(id);
+      row.ipowner       = s->ipowner;
+      row.issuer        = s->issuer;
+      row.issued_at     = s->created_at;
+   });
+}
+
+/**
+ * The `tokenstats` table holding `id`: its shard, or the contract scope while unsharded or
+ * while the row still waits for `migrateshard`. New rows always go to the shard.
+ */
+nstats_t::idx_t& ntoken::_stats_table( const uint32_t& id ) {
+   if ( !_shardconf.sharded() ) return _nstats();
+
+   auto& shard = _stats_tables.get( _self, _shardconf.scope(id) );
+   if ( _shardconf.migrated || shard.find( id ) != shard.end() ) return shard;
+
+   auto& legacy = _nstats();
+   return ( legacy.find( id ) != legacy.end() ) ? legacy : shard;
+}
+
+bool ntoken::_token_in_range( const uint32_t& first_id, const uint32_t& last_id ) {
+   if ( !_shardconf.migrated ) {
+      auto& nstats = _nstats();
+      auto itr = nstats.lower_bound( first_id );
+      if ( itr != nstats.end() && itr->supply.symbol.id <= last_id ) return true;
+   }
+   // every plain token created since sharding sits below `next_id`, so shards above it are empty
+   if ( !_shardconf.sharded() || first_id >= _shardconf.next_id ) return false;
+
+   auto last_scope = _shardconf.scope( std::min( last_id, _shardconf.next_id - 1 ) );
+   for( auto scope = _shardconf.scope(first_id); scope <= last_scope; scope++ ) {
+      auto& shard = _stats_tables.get( _self, scope );
+      auto itr = shard.lower_bound( first_id );
+      if ( itr != shard.end() && itr->supply.symbol.id <= last_id ) return true;
+   }
+   return false;
+}
+
+void ntoken::_check_token_uri( const string& token_uri ) {
+   if ( !_shardconf.migrated ) {
+      auto idx = _nstats().get_index<"tokenuriidx"_n>();
+      check( idx.find( HASH256(token_uri) ) == idx.end(), "token with token_uri already exists" );
+   }
+   if ( _shardconf.sharded() ) {
+      auto& uris = _tokenuris();
+      check( uris.find( tokenuri_t::key_of(token_uri) ) == uris.end(), "token with token_uri already exists" );
+   }
+}
+
+void ntoken::_register_token_uri( const string& token_uri, const uint32_t& id, const name& ram_payer ) {
+   if ( !_shardconf.sharded() ) return;
+
+   auto& uris = _tokenuris();
+   auto key = tokenuri_t::key_of( token_uri );
+   if ( uris.find( key ) != uris.end() ) return;
+
+   uris.emplace( ram_payer, [&]( auto& u ) {
+      u.key = key;
+      u.id  = id;
+   });
+}
+
+void ntoken::_unregister_token_uri( const string& token_uri, const uint32_t& id ) {
+   if ( !_shardconf.sharded() ) return;
+
+   auto& uris = _tokenuris();
+   auto itr = uris.find( tokenuri_t::key_of( token_uri ) );
+   if ( itr != uris.end() && itr->id == id )
+      uris.erase( itr );
+}
+
+void ntoken::setsharding( const uint32_t& shard_size ) {
+   require_auth( _self );
+   check( !_shardconf.sharded(), "tokenstats already sharded" );
+   check( shard_size > 0, "shard size must be positive" );
+
+   auto& nstats = _nstats();
+   _shardconf.shard_size   = shard_size;
+   _shardconf.next_id      = nstats.available_primary_key();
+   _shardconf.migrated     = ( nstats.begin() == nstats.end() );
+}
+
+void ntoken::migrateshard( const uint32_t& max_rows ) {
+   require_auth( _self );
+   check( _shardconf.sharded(), "tokenstats not sharded" );
+   check( !_shardconf.migrated, "tokenstats already migrated" );
+   check( max_rows > 0, "max_rows must be positive" );
+
+   // moved rows are re-created with the contract as payer: the issuers who paid for them
+   // are not signing here, so their RAM is released and the contract's is used instead
+   auto& nstats = _nstats();
+   auto itr = nstats.begin();
+   for( uint32_t rows = 0; itr != nstats.end() && rows < max_rows; rows++ ) {
+      auto id = itr->supply.symbol.id;
+      _stats_tables.get( _self, _shardconf.scope(id) ).emplace( _self, [&]( auto& row ) {
+         row = *itr;
+      });
+      _register_token_uri( itr->token_uri, id, _self );
+      itr = nstats.erase( itr );
+   }
+   _shardconf.migrated = ( itr == nstats.end() );
+}
+
+bool ntoken::_stats_tracked( const uint32_t& id ) {
+   if ( _gstats.has_token(id) ) return true;
+
+   auto& series = _series();
+   return find_series( series, id ) != series.end();
+}
+
+void ntoken::approve( const name& owner, const name& op, const vector<nsymbol>& symbols, const bool& approved ) {
+   require_auth( owner );
+   check( owner != op, "cannot approve self" );
+   check( is_account( op ), "operator account does not exist" );
+
+   vector<uint64_t> raws;
+   raws.reserve( symbols.size() );
+   for( auto& sym : symbols ) raws.push_back( sym.raw() );
+   std::sort( raws.begin(), raws.end() );
+   raws.erase( std::unique( raws.begin(), raws.end() ), raws.end() );
+
+   auto& approvals = _approvals( owner );
+   auto itr = approvals.find( op.value );
+
+   if ( approved ) {
+      if ( itr == approvals.end() ) {
+         approvals.emplace( owner, [&]( auto& a ) {
+            a.op        = op;
+            a.symbols   = raws;
+         });
+         return;
+      }
+      if ( itr->symbols.empty() ) return; // already approved for all symbols
+
+      approvals.modify( itr, owner, [&]( auto& a ) {
+         if ( raws.empty() ) { a.symbols.clear(); return; }
+
+         vector<uint64_t> merged;
+         std::set_union( a.symbols.begin(), a.symbols.end(), raws.begin(), raws.end(), std::back_inserter(merged) );
+         a.symbols = std::move( merged );
+      });
+      return;
+   }
+
+   check( itr != approvals.end(), "operator not approved" );
+   if ( raws.empty() ) {
+      approvals.erase( itr );
+      return;
+   }
+
+   check( !itr->symbols.empty(), "revoke the all-symbol approval as a whole" );
+   vector<uint64_t> remaining;
+   std::set_difference( itr->symbols.begin(), itr->symbols.end(), raws.begin(), raws.end(), std::back_inserter(remaining) );
+   if ( remaining.empty() ) {
+      approvals.erase( itr );
+      return;
+   }
+   approvals.modify( itr, owner, [&]( auto& a ) {
+      a.symbols = std::move( remaining );
+   });
+}
+
+void ntoken::transferfrom( const name& op, const vector<ntransfer>& transfers, const string& memo ) {
+   require_auth( op );
+   check( transfers.size() > 0, "no transfers" );
+   check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+   map<name, approval_t>                     approvals;     // each sender's approval, read once
+   set<name>                                 recipients;
+   set<uint64_t>                             symbols;
+   map<pair<name, uint64_t>, nasset>         deltas;        // net change per (account, symbol)
+   map<pair<name, uint64_t>, int64_t>        debits;        // gross amount sent per (sender, symbol)
+
+   for( auto& t : transfers ) {
+      check( t.from != t.to, "cannot transfer to self" );
+      check( t.quantity.amount > 0, "must transfer positive quantity" );
+      if ( symbols.insert( t.quantity.symbol.raw() ).second ) {
+         check( t.quantity.symbol == _token_symbol( t.quantity.symbol.id ), "symbol precision mismatch" );
+         _check_not_paused( t.quantity.symbol );
+      }
+
+      auto approval = approvals.find( t.from );
+      if ( approval == approvals.end() ) {
+         auto& from_approvals = _approvals( t.from );
+         auto itr = from_approvals.find( op.value );
+         CHECK( itr != from_approvals.end(), "operator not approved by " + t.from.to_string() );
+         approval = approvals.emplace( t.from, *itr ).first;
+         require_recipient( t.from );
+      }
+      CHECK( approval->second.allows( t.quantity.symbol ), "operator not approved for token " + to_string(t.quantity.symbol.id) + " by " + t.from.to_string() );
+
+      if ( recipients.insert( t.to ).second ) {
+         check( is_account( t.to ), "to account does not exist" );
+         require_recipient( t.to );
+      }
+
+      auto sym = t.quantity.symbol.raw();
+      auto& sent = debits[ make_pair( t.from, sym ) ];
+      check( t.quantity.amount <= std::numeric_limits<int64_t>::max() - sent, "transfer amount overflow" );
+      sent += t.quantity.amount;
+
+      auto debit = deltas.emplace( make_pair( t.from, sym ), nasset( 0, t.quantity.symbol ) ).first;
+      debit->second -= t.quantity;
+      auto credit = deltas.emplace( make_pair( t.to, sym ), nasset( 0, t.quantity.symbol ) ).first;
+      credit->second += t.quantity;
+   }
+
+   // checked before netting, so a zero or positive net change cannot hide an unbacked debit
+   for( auto& [ key, sent ] : debits ) {
+      auto& acnts = _accounts( key.first );
+      auto itr = acnts.find( key.second );
+      check( itr != acnts.end(), "no balance object found" );
+      check( itr->balance.amount >= sent, "overdrawn balance" );
+   }
+
+   for( auto& [ key, delta ] : deltas ) {
+      if ( delta.amount < 0 )
+         sub_balance( key.first, nasset( -delta.amount, delta.symbol ), false );
+      else if ( delta.amount > 0 )
+         add_balance( key.first, delta, op );
+   }
+}
+
+void ntoken::sub_balance( const name& owner, const nasset& value, const bool& owner_pays ) {
+   auto& from_acnts = _accounts( owner );
 
    const auto& from = from_acnts.get( value.symbol.raw(), "no balance object found" );
    check( from.balance.amount >= value.amount, "overdrawn balance" );
 
-   from_acnts.modify( from, owner, [&]( auto& a ) {
+   from_acnts.modify( from, owner_pays ? owner : same_payer, [&]( auto& a ) {
          a.balance -= value;
       });
 }
 
 void ntoken::add_balance( const name& owner, const nasset& value, const name& ram_payer )
 {
-   auto to_acnts = account_t::idx_t( get_self(), owner.value );
+   auto& to_acnts = _accounts( owner );
    auto to = to_acnts.find( value.symbol.raw() );
    if( to == to_acnts.end() ) {
+      _count_balance_row( owner, to_acnts );
       to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
@@ -189,17 +706,113 @@ void ntoken::add_balance( const name& owner, const nasset& value, const name& ra
    }
 }
 
+void ntoken::_count_balance_row( const name& owner, const account_t::idx_t& acnts ) {
+   if ( !_gstats.has_owner(owner) ) return;
+
+   if ( acnts.begin() == acnts.end() ) _gstats.holders++;
+   _gstats.balances++;
+}
+
+void ntoken::initstats( const uint32_t& max_rows, const vector<name>& owners ) {
+   require_auth( _self );
+   check( max_rows > 0, "max_rows must be positive" );
+
+   uint32_t rows = 0;
+   if ( _gstats.token_cursor != MAX_TOKEN_CURSOR ) {
+      check( owners.empty(), "tokenstats backfill not finished yet" );
+      check( !_shardconf.sharded() || _shardconf.migrated, "tokenstats migration not finished yet" );
+
+      auto& series = _series();
+      auto cursor = _gstats.token_cursor;
+      while ( cursor != MAX_TOKEN_CURSOR && rows < max_rows ) {
+         auto& nstats = _stats_table( cursor );
+         auto itr = nstats.lower_bound( cursor );
+         for( ; itr != nstats.end() && rows < max_rows; itr++, rows++ ) {
+            if ( find_series( series, itr->supply.symbol.id ) != series.end() ) continue;
+
+            _gstats.tokens++;
+            _gstats.supply += itr->supply.amount;
+            if ( itr->notary.value != 0 ) _gstats.notarized++;
+         }
+
+         if ( itr != nstats.end() ) {
+            cursor = itr->supply.symbol.id;
+         } else if ( _shardconf.sharded() && ( _shardconf.scope(cursor) + 1 ) * _shardconf.shard_size < _shardconf.next_id ) {
+            cursor = ( _shardconf.scope(cursor) + 1 ) * _shardconf.shard_size;
+            rows++;     // empty shards count against the chunk too
+         } else {
+            cursor = MAX_TOKEN_CURSOR;
+         }
+      }
+      _gstats.token_cursor = cursor;
+      return;
+   }
+
+   check( _gstats.owner_cursor != MAX_OWNER_CURSOR, "stats already backfilled" );
+   if ( owners.empty() ) {
+      _gstats.owner_cursor = MAX_OWNER_CURSOR;
+      return;
+   }
+
+   // an owner scope is always counted as a whole, so the cursor never splits it
+   for( auto& owner : owners ) {
+      if ( rows >= max_rows ) break;
+      CHECK( owner.value > _gstats.owner_cursor.value, "owners must be ascending: " + owner.to_string() );
+
+      auto& acnts = _accounts( owner );
+      auto itr = acnts.begin();
+      if ( itr != acnts.end() ) _gstats.holders++;
+      for( ; itr != acnts.end(); itr++, rows++ )
+         _gstats.balances++;
+
+      _gstats.owner_cursor = owner;
+   }
+}
+
 void ntoken::setcreator( const name& creator, const bool& to_add){
    require_auth( _self );
 
    check( is_account( creator ), "creator does not exist");
 
    if ( to_add ){
-      _gstate.creators.insert( creator );
+      global_t::insert( _gstate.creators, creator );
 
    } else {
-      check( _gstate.creators.find( creator ) != _gstate.creators.end(), "creator not found:" + creator.to_string() );
-      _gstate.creators.erase( creator );
+      CHECK( global_t::erase( _gstate.creators, creator ), "creator not found:" + creator.to_string() );
+   }
+}
+
+void ntoken::setattrs( const name& issuer, const vector<nattrs>& attrs ) {
+   require_auth( issuer );
+   check( attrs.size() > 0, "no attributes" );
+
+   for( auto& a : attrs ) {
+      if ( a.parent )
+         check( a.id != 0, "parent id 0 takes no defaults" );
+      else
+         CHECK( _token_issuer( a.id ) == issuer, "not issuer of token: " + to_string(a.id) );
+
+      // parent defaults live in the issuer's own scope, only its tokens inherit them
+      auto& table = _attrs( a.parent ? issuer : _self );
+      auto itr = table.find( a.id );
+      attr_t row;
+      row.key = a.id;
+      if ( itr != table.end() ) row.tlv = itr->tlv;
+
+      for( auto& attr : a.attrs ) {
+         check( attr.value.size() <= attr_t::MAX_VALUE_SIZE, "attribute value too long" );
+         row.set( attr.tag, attr.value );
+      }
+
+      if ( itr == table.end() ) {
+         if ( !row.tlv.empty() ) table.emplace( issuer, [&]( auto& r ) { r = row; } );
+
+      } else if ( row.tlv.empty() ) {
+         table.erase( itr );
+
+      } else {
+         table.modify( itr, issuer, [&]( auto& r ) { r.tlv = row.tlv; } );
+      }
    }
 }
 
@@ -207,18 +820,128 @@ void ntoken::_creator_auth_check( const name& creator){
       if ( _gstate.creators.size() == 0 )
          return;
 
-      auto found = _gstate.creators.find(creator) != _gstate.creators.end();
-      check( found, "creator not authorized: " + creator.to_string() );  
+      auto found = global_t::contains( _gstate.creators, creator );
+      CHECK( found, "creator not authorized: " + creator.to_string() );
 
       auto is_auth = false;
-      auto did_acnts = account_t::idx_t( DID_CONTRACT, creator.value );
+      auto& did_acnts = _acnt_tables.get( DID_CONTRACT, creator.value );
       for( auto did_acnts_iter = did_acnts.begin(); did_acnts_iter != did_acnts.end(); did_acnts_iter++ ) {
          if( did_acnts_iter->balance.amount > 0 ) {
                is_auth = true;
                break;
          }
       }
-      check( is_auth, "creator has no DID: " + creator.to_string() );   
+      CHECK( is_auth, "creator has no DID: " + creator.to_string() );
+}
+
+#ifdef NTOKEN_CUSTOM_DISPATCH
+
+/// packed `nasset` array read in place from action data, 16 bytes per asset: amount, id, pid
+class nasset_view {
+   public:
+      static constexpr size_t packed_size = sizeof(int64_t) + 2 * sizeof(uint32_t);
+
+      class iterator {
+         public:
+            explicit iterator( const char* pos ): _pos(pos) {}
+
+            nasset operator*()const {
+               nasset a;
+               memcpy( &a.amount,     _pos,      sizeof(int64_t) );
+               memcpy( &a.symbol.id,  _pos + 8,  sizeof(uint32_t) );
+               memcpy( &a.symbol.pid, _pos + 12, sizeof(uint32_t) );
+               return a;
+            }
+            iterator& operator++()                      { _pos += packed_size; return *this; }
+            bool operator!=( const iterator& o )const   { return _pos != o._pos; }
+
+         private:
+            const char* _pos;
+      };
+
+      nasset_view( const char* data, uint32_t count ): _data(data), _count(count) {}
+
+      iterator begin()const  { return iterator( _data ); }
+      iterator end()const    { return iterator( _data + _count * packed_size ); }
+      uint32_t size()const   { return _count; }
+
+   private:
+      const char* _data;
+      uint32_t    _count;
+};
+
+/// skips a length-prefixed string in `ds` and returns its length
+static uint32_t skip_string( datastream<const char*>& ds ) {
+   unsigned_int len;
+   ds >> len;
+   check( ds.remaining() >= len.value, "read" );
+   ds.skip( len.value );
+   return len.value;
+}
+
+bool ntoken::fast_dispatch( const name& receiver, const name& code, const name& action ) {
+   if ( action != "transfer"_n && action != "issue"_n && action != "retire"_n )
+      return false;
+
+   constexpr size_t max_stack_buffer_size = 512;
+   size_t size = action_data_size();
+   char* buffer = (char*)( max_stack_buffer_size < size ? malloc(size) : alloca(size) );
+   read_action_data( buffer, size );
+   datastream<const char*> ds( buffer, size );
+
+   ntoken self( receiver, code, datastream<const char*>( buffer, size ) );
+   if ( action == "transfer"_n ) {
+      name from, to;
+      unsigned_int count;
+      ds >> from >> to >> count;
+      // divide instead of multiplying: count * packed_size can wrap in 32-bit size_t
+      check( count.value <= ds.remaining() / nasset_view::packed_size, "read" );
+      nasset_view assets( ds.pos(), count.value );
+      ds.skip( count.value * nasset_view::packed_size );
+      self._transfer( from, to, assets, skip_string( ds ) );
+
+   } else if ( action == "issue"_n ) {
+      name to;
+      nasset quantity;
+      ds >> to >> quantity;
+      self._issue( to, quantity, skip_string( ds ) );
+
+   } else {
+      nasset quantity;
+      ds >> quantity;
+      self._retire( quantity, skip_string( ds ) );
+   }
+
+   if ( max_stack_buffer_size < size )
+      free( buffer );
+   return true;
 }
 
-} //namespace flon
\ No newline at end of file
+#endif
+
+} //namespace flon
+
+#ifdef NTOKEN_CUSTOM_DISPATCH
+/**
+ * Replaces the generated dispatcher: `transfer`, `issue` and `retire` read their assets and memo
+ * in place, every other action is dispatched exactly as the generated code would, see
+ * `NTOKEN_EXECUTED_ACTIONS`. tests/flon.ntoken_dispatch_tests.cpp checks both builds match.
+ */
+extern "C" {
+   [[eosio::wasm_entry]]
+   void apply( uint64_t receiver, uint64_t code, uint64_t action ) {
+      using namespace eosio;
+      using flon::ntoken;
+      if ( receiver != code ) return;
+      if ( ntoken::fast_dispatch( name(receiver), name(code), name(action) ) ) return;
+
+      switch( action ) {
+#define NTOKEN_EXECUTE( act ) \
+         case name( #act ).value: execute_action( name(receiver), name(code), &ntoken::act ); break;
+         NTOKEN_EXECUTED_ACTIONS( NTOKEN_EXECUTE )
+#undef NTOKEN_EXECUTE
+         default:                      check( false, "unknown action" );
+      }
+   }
+}
+#endif
@@ -0,0 +1,84 @@
+#include "flon.ntoken_tester.hpp"
+
+class didtoken_tester : public ntoken_tester {
+public:
+   static constexpr name DIDTOKEN = "did.ntoken"_n;
+
+   didtoken_tester(): ntoken_tester( DIDTOKEN, contracts::didtoken_wasm(), contracts::didtoken_abi() ) {}
+
+   action_result allow_recv( const name& issuer, const name& to, const uint32_t& id ) {
+      return push_action( issuer, "setacctperms"_n, mvo()( "issuer", issuer )( "to", to )( "symbol", nsymbol( id ) )
+         ( "allowsend", false )( "allowrecv", true ) );
+   }
+
+   action_result burn( const name& issuer, const name& owner, const int64_t& amount, const uint32_t& id ) {
+      return push_action( issuer, "burn"_n, mvo()( "owner", owner )( "quantity", nasset( amount, id ) )( "memo", "" ) );
+   }
+
+   action_result audit( const uint32_t& max_rows, const vector<name>& owners ) {
+      return push_action( DIDTOKEN, "audit"_n, mvo()( "max_rows", max_rows )( "owners", owners ) );
+   }
+
+   variant auditstate() {
+      return get_singleton( "auditstate"_n, "auditstate_t" );
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(didtoken_audit_tests)
+
+BOOST_FIXTURE_TEST_CASE( audit_follows_balances_between_chunks, didtoken_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 100, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 1 ) );
+   for ( auto to : { "bob"_n, "carol"_n, "dave"_n } )
+      BOOST_REQUIRE_EQUAL( success(), allow_recv( "alice"_n, to, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 1, 1 ) );
+
+   BOOST_REQUIRE_EQUAL( error( "missing authority of did.ntoken" ), push_action( "alice"_n, "audit"_n, mvo()( "max_rows", 10 )( "owners", vector<name>{} ) ) );
+   BOOST_REQUIRE_EQUAL( success(), audit( 10, { "alice"_n } ) );
+   BOOST_REQUIRE_EQUAL( 1, auditstate()["phase"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( "alice", auditstate()["owner_cursor"].as_string() );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "owners must be ascending: alice" ), audit( 10, { "alice"_n } ) );
+
+   // alice is summed already: her transfer to carol and the burn must reach the sums
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "carol"_n, 1, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), burn( "alice"_n, "alice"_n, 1, 1 ) );
+
+   BOOST_REQUIRE_EQUAL( success(), audit( 10, { "bob"_n, "carol"_n, "dave"_n } ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( "bob"_n, "dave"_n, 1, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), audit( 10, {} ) );
+   BOOST_REQUIRE_EQUAL( 2, auditstate()["phase"].as_uint64() );
+
+   // once comparing, every owner counts as summed
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 5, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), audit( 10, {} ) );
+
+   auto state = auditstate();
+   BOOST_REQUIRE_EQUAL( 0, state["phase"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, state["pass"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 0, state["mismatches"].as_uint64() );
+   BOOST_REQUIRE( get_row( DIDTOKEN, "auditdiffs"_n, 1, "auditdiff_t" ).is_null() );
+   BOOST_REQUIRE_EQUAL( 14, supply( 1 ) );
+   BOOST_REQUIRE_EQUAL( 14, get_row( DIDTOKEN, "auditsums"_n, 1, "auditsum_t" )["balances"].as_int64() );
+
+   // outside a pass balance changes leave the sums alone
+   BOOST_REQUIRE_EQUAL( success(), burn( "alice"_n, "alice"_n, 1, 1 ) );
+   BOOST_REQUIRE_EQUAL( 14, get_row( DIDTOKEN, "auditsums"_n, 1, "auditsum_t" )["balances"].as_int64() );
+} FC_LOG_AND_RETHROW()
+
+/// CPU of the did.ntoken hot paths that go through the per-action table cache
+BOOST_FIXTURE_TEST_CASE( did_cpu, didtoken_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 100, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), allow_recv( "alice"_n, "bob"_n, 1 ) );
+
+   bench( "issue_cpu_us", measure( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 10, 1 ) )( "memo", "" ) ).cpu_us );
+   bench( "transfer_cpu_us", measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )
+      ( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) ).cpu_us );
+   bench( "burn_cpu_us", measure( "alice"_n, "burn"_n, mvo()( "owner", "alice" )( "quantity", nasset( 1, 1 ) )( "memo", "" ) ).cpu_us );
+
+   // the same paths while an audit pass is running, which also keeps its sums current
+   BOOST_REQUIRE_EQUAL( success(), audit( 10, { "alice"_n, "bob"_n } ) );
+   bench( "burn_during_audit_cpu_us", measure( "alice"_n, "burn"_n, mvo()( "owner", "alice" )( "quantity", nasset( 1, 1 ) )( "memo", "" ) ).cpu_us );
+   BOOST_REQUIRE_EQUAL( 7, balance( "alice"_n, 1 ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
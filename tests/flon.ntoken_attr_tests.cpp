@@ -0,0 +1,82 @@
+#include "flon.ntoken_tester.hpp"
+
+class ntoken_attr_tester : public ntoken_tester {
+public:
+   static mvo attrs( const uint32_t& id, const bool& parent, const vector<std::pair<uint8_t, bytes>>& tags ) {
+      vector<variant> list;
+      for ( auto& [ tag, value ] : tags )
+         list.push_back( mvo()( "tag", tag )( "value", value ) );
+      return mvo()( "id", id )( "parent", parent )( "attrs", list );
+   }
+
+   action_result setattrs( const name& issuer, const vector<variant>& entries ) {
+      return push_action( issuer, "setattrs"_n, mvo()( "issuer", issuer )( "attrs", entries ) );
+   }
+
+   /// packed tag-length-value blob of the `attrs` row `key` in `scope`, empty when missing
+   bytes tlv( const name& scope, const uint64_t& key ) {
+      auto row = get_row( scope, "attrs"_n, key, "attr_t" );
+      return row.is_null() ? bytes() : row["tlv"].as<bytes>();
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_attr_tests)
+
+BOOST_FIXTURE_TEST_CASE( setattrs_rows, ntoken_attr_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1, 2, 7 ) );
+   BOOST_REQUIRE_EQUAL( success(), create( "bob"_n, 1, 3, 7 ) );
+
+   // tags are kept in ascending order whatever order they are set in
+   BOOST_REQUIRE_EQUAL( success(), setattrs( "alice"_n, { attrs( 1, false, { { 9, { 'b', 'b' } }, { 2, { 'a' } } } ) } ) );
+   BOOST_REQUIRE( tlv( NTOKEN, 1 ) == bytes( { 2, 1, 'a', 9, 2, 'b', 'b' } ) );
+   BOOST_REQUIRE_EQUAL( success(), setattrs( "alice"_n, { attrs( 1, false, { { 2, {} }, { 5, { 'c' } } } ) } ) );
+   BOOST_REQUIRE( tlv( NTOKEN, 1 ) == bytes( { 5, 1, 'c', 9, 2, 'b', 'b' } ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "not issuer of token: 1" ), setattrs( "bob"_n, { attrs( 1, false, { { 1, { 'x' } } } ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "parent id 0 takes no defaults" ), setattrs( "bob"_n, { attrs( 0, true, { { 1, { 'x' } } } ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token not found: 99" ), setattrs( "alice"_n, { attrs( 99, false, { { 1, { 'x' } } } ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "attribute value too long" ), setattrs( "alice"_n, { attrs( 1, false, { { 1, bytes( 256, 'x' ) } } ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "no attributes" ), setattrs( "alice"_n, {} ) );
+
+   // parent defaults live in each issuer's scope, so bob cannot set what alice's tokens inherit
+   BOOST_REQUIRE_EQUAL( success(), setattrs( "alice"_n, { attrs( 7, true, { { 1, { 'r' } } } ) } ) );
+   BOOST_REQUIRE_EQUAL( success(), setattrs( "bob"_n, { attrs( 7, true, { { 1, { 'z' } } } ) } ) );
+   BOOST_REQUIRE( tlv( "alice"_n, 7 ) == bytes( { 1, 1, 'r' } ) );
+   BOOST_REQUIRE( tlv( "bob"_n, 7 ) == bytes( { 1, 1, 'z' } ) );
+   BOOST_REQUIRE( tlv( NTOKEN, 7 ).empty() );
+
+   // removing the last tag removes the row
+   BOOST_REQUIRE_EQUAL( success(), setattrs( "alice"_n, { attrs( 7, true, { { 1, {} } } ), attrs( 1, false, { { 5, {} }, { 9, {} } } ) } ) );
+   BOOST_REQUIRE( get_row( "alice"_n, "attrs"_n, 7, "attr_t" ).is_null() );
+   BOOST_REQUIRE( get_row( NTOKEN, "attrs"_n, 1, "attr_t" ).is_null() );
+} FC_LOG_AND_RETHROW()
+
+/// RAM the issuer pays for a token's attributes, by number of tags and value size
+BOOST_FIXTURE_TEST_CASE( setattrs_ram_per_attribute, ntoken_attr_tester ) try {
+   create_many( "alice"_n, 1, 1, 20 );
+
+   uint32_t id = 1;
+   for ( uint32_t value_size : { 1, 4, 32 } ) {
+      for ( uint32_t count : { 1, 4, 16 } ) {
+         vector<std::pair<uint8_t, bytes>> tags;
+         for ( uint32_t tag = 1; tag <= count; tag++ )
+            tags.emplace_back( tag, bytes( value_size, 'v' ) );
+
+         auto before = ram_usage( "alice"_n );
+         BOOST_REQUIRE_EQUAL( success(), setattrs( "alice"_n, { attrs( id++, false, tags ) } ) );
+         auto used = ram_usage( "alice"_n ) - before;
+
+         auto suffix = std::to_string( count ) + "_tags_" + std::to_string( value_size ) + "_byte_values";
+         bench( "attr_row_ram_bytes_" + suffix, used );
+         bench( "attr_ram_bytes_per_tag_" + suffix, used / count );
+      }
+   }
+
+   // one more tag on an existing row only grows the blob by its header and value
+   auto before = ram_usage( "alice"_n );
+   BOOST_REQUIRE_EQUAL( success(), setattrs( "alice"_n, { attrs( 1, false, { { 200, bytes( 4, 'v' ) } } ) } ) );
+   bench( "attr_added_tag_ram_bytes_4_byte_value", ram_usage( "alice"_n ) - before );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
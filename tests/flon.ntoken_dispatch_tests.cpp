@@ -0,0 +1,202 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/testing/tester.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include "contracts.hpp"
+
+using namespace eosio::testing;
+using namespace eosio;
+using namespace eosio::chain;
+using namespace fc;
+using namespace std;
+
+using mvo = fc::mutable_variant_object;
+
+/**
+ * Deploys flon.ntoken twice, with the generated dispatcher and with NTOKEN_CUSTOM_DISPATCH,
+ * pushes the same actions to both and requires the same results and the same table rows.
+ */
+class ntoken_dispatch_tester : public tester {
+public:
+   static constexpr name GEN  = "ntoken.gen"_n;
+   static constexpr name FAST = "ntoken.fast"_n;
+
+   ntoken_dispatch_tester() {
+      produce_blocks( 2 );
+      create_accounts( { "alice"_n, "bob"_n, GEN, FAST } );
+      produce_blocks( 2 );
+
+      set_code( GEN, contracts::ntoken_wasm() );
+      set_abi( GEN, contracts::ntoken_abi().data() );
+      set_code( FAST, contracts::ntoken_fastdispatch_wasm() );
+      set_abi( FAST, contracts::ntoken_abi().data() );
+      produce_blocks();
+
+      const auto& accnt = control->db().get<account_object,by_name>( GEN );
+      BOOST_REQUIRE_EQUAL( abi_serializer::to_abi(accnt.abi, abi), true );
+      abi_ser.set_abi( abi, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   action_result push_raw( const name& contract, const account_name& signer, const action_name& act_name, const bytes& data ) {
+      action act;
+      act.account = contract;
+      act.name    = act_name;
+      act.data    = data;
+      return base_tester::push_action( std::move(act), signer.to_uint64_t() );
+   }
+
+   bytes to_binary( const action_name& act_name, const variant_object& data ) {
+      return abi_ser.variant_to_binary( abi_ser.get_action_type(act_name), data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   /// pushes `data` to both builds and requires the exact same result
+   action_result push_both( const account_name& signer, const action_name& act_name, const bytes& data ) {
+      auto gen  = push_raw( GEN, signer, act_name, data );
+      auto fast = push_raw( FAST, signer, act_name, data );
+      BOOST_REQUIRE_EQUAL( gen, fast );
+      return gen;
+   }
+
+   action_result push_both( const account_name& signer, const action_name& act_name, const variant_object& data ) {
+      return push_both( signer, act_name, to_binary( act_name, data ) );
+   }
+
+   /// malformed data may fail with different messages, but must fail or succeed in both builds
+   void require_same_outcome( const account_name& signer, const action_name& act_name, const bytes& data ) {
+      auto gen  = push_raw( GEN, signer, act_name, data );
+      auto fast = push_raw( FAST, signer, act_name, data );
+      BOOST_REQUIRE_EQUAL( gen == success(), fast == success() );
+   }
+
+   /// `tokenstats` row without its timestamps, which differ by block between the two pushes
+   string token_row( const name& contract, const uint32_t& id ) {
+      auto data = get_row_by_account( contract, contract, "tokenstats"_n, name(id) );
+      if ( data.empty() ) return "";
+      mvo row( abi_ser.binary_to_variant( "nstats_t", data, abi_serializer::create_yield_function(abi_serializer_max_time) ) );
+      row.erase( "issued_at" );
+      row.erase( "notarized_at" );
+      return fc::json::to_string( row, fc::time_point::maximum() );
+   }
+
+   void require_same_rows( const vector<uint32_t>& ids, const vector<name>& owners ) {
+      BOOST_REQUIRE( get_row_by_account( GEN, GEN, "gstats"_n, "gstats"_n )
+                  == get_row_by_account( FAST, FAST, "gstats"_n, "gstats"_n ) );
+      for ( auto id : ids ) {
+         BOOST_REQUIRE_EQUAL( token_row( GEN, id ), token_row( FAST, id ) );
+         for ( auto owner : owners ) {
+            BOOST_REQUIRE( get_row_by_account( GEN, owner, "accounts"_n, name(id) )
+                        == get_row_by_account( FAST, owner, "accounts"_n, name(id) ) );
+         }
+      }
+   }
+
+   static mvo nasset( const int64_t& amount, const uint32_t& id, const uint32_t& pid = 0 ) {
+      return mvo()( "amount", amount )( "symbol", mvo()( "id", id )( "pid", pid ) );
+   }
+
+   /// `transfer` data with `count` announced and `assets` as the raw asset bytes that follow it
+   static bytes transfer_data( const name& from, const name& to, const uint32_t& count, const bytes& assets, const string& memo ) {
+      bytes data = fc::raw::pack( from );
+      auto append = [&]( const bytes& b ) { data.insert( data.end(), b.begin(), b.end() ); };
+      append( fc::raw::pack( to ) );
+      append( fc::raw::pack( fc::unsigned_int( count ) ) );
+      append( assets );
+      append( fc::raw::pack( memo ) );
+      return data;
+   }
+
+   static bytes packed_asset( const int64_t& amount, const uint32_t& id, const uint32_t& pid = 0 ) {
+      bytes data = fc::raw::pack( amount );
+      for ( auto& part : { fc::raw::pack( id ), fc::raw::pack( pid ) } )
+         data.insert( data.end(), part.begin(), part.end() );
+      return data;
+   }
+
+   void create_tokens() {
+      for ( uint32_t id : { 1, 2 } ) {
+         BOOST_REQUIRE_EQUAL( success(), push_both( "alice"_n, "create"_n, mvo()
+            ( "issuer", "alice" )( "maximum_supply", 100 )( "symbol", mvo()( "id", id )( "pid", 0 ) )
+            ( "token_uri", "uri://" + std::to_string(id) )( "ipowner", "" ) ) );
+      }
+   }
+
+   abi_def         abi;
+   abi_serializer  abi_ser;
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_dispatch_tests)
+
+BOOST_FIXTURE_TEST_CASE( transfer_issue_retire_match, ntoken_dispatch_tester ) try {
+   create_tokens();
+
+   BOOST_REQUIRE_EQUAL( success(), push_both( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 50, 1 ) )( "memo", "" ) ) );
+   BOOST_REQUIRE_EQUAL( success(), push_both( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 10, 2 ) )( "memo", "m" ) ) );
+   push_both( "alice"_n, "issue"_n, mvo()( "to", "bob" )( "quantity", nasset( 1, 1 ) )( "memo", "" ) );
+   push_both( "bob"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 1, 1 ) )( "memo", "" ) );
+   push_both( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 1, 3 ) )( "memo", "" ) );
+   push_both( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 1000, 1 ) )( "memo", "" ) );
+   push_both( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 1, 1 ) )( "memo", string( 257, 'x' ) ) );
+   require_same_rows( { 1, 2 }, { "alice"_n, "bob"_n } );
+
+   BOOST_REQUIRE_EQUAL( success(), push_both( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )
+      ( "assets", vector<variant>{ nasset( 5, 1 ), nasset( 2, 2 ) } )( "memo", "both" ) ) );
+   push_both( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "alice" )( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) );
+   push_both( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )( "assets", vector<variant>{ nasset( 1000, 1 ) } )( "memo", "" ) );
+   push_both( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )( "assets", vector<variant>{ nasset( 1, 1, 7 ) } )( "memo", "" ) );
+   push_both( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )( "assets", vector<variant>{ nasset( 0, 1 ) } )( "memo", "" ) );
+   push_both( "bob"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) );
+   push_both( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", string( 257, 'x' ) ) );
+   push_both( "bob"_n, "transfer"_n, mvo()( "from", "bob" )( "to", "alice" )( "assets", vector<variant>{} )( "memo", "" ) );
+   require_same_rows( { 1, 2 }, { "alice"_n, "bob"_n } );
+
+   BOOST_REQUIRE_EQUAL( success(), push_both( "alice"_n, "retire"_n, mvo()( "quantity", nasset( 3, 1 ) )( "memo", "" ) ) );
+   push_both( "bob"_n, "retire"_n, mvo()( "quantity", nasset( 1, 1 ) )( "memo", "" ) );
+   push_both( "alice"_n, "retire"_n, mvo()( "quantity", nasset( 1000, 1 ) )( "memo", "" ) );
+   push_both( "alice"_n, "retire"_n, mvo()( "quantity", nasset( 1, 9 ) )( "memo", "" ) );
+   require_same_rows( { 1, 2 }, { "alice"_n, "bob"_n } );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( malformed_payloads_match, ntoken_dispatch_tester ) try {
+   create_tokens();
+   BOOST_REQUIRE_EQUAL( success(), push_both( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 50, 1 ) )( "memo", "" ) ) );
+
+   auto one = packed_asset( 1, 1 );
+   // asset count far above the data: 2^28 + 1 assets of 16 bytes wraps a 32-bit size
+   require_same_outcome( "alice"_n, "transfer"_n, transfer_data( "alice"_n, "bob"_n, (1u << 28) + 1, one, "" ) );
+   require_same_outcome( "alice"_n, "transfer"_n, transfer_data( "alice"_n, "bob"_n, 2, one, "" ) );
+
+   auto truncated = transfer_data( "alice"_n, "bob"_n, 1, one, "" );
+   truncated.resize( truncated.size() - 4 );
+   require_same_outcome( "alice"_n, "transfer"_n, truncated );
+
+   auto trailing = transfer_data( "alice"_n, "bob"_n, 1, one, "" );
+   trailing.push_back( 0x7f );
+   require_same_outcome( "alice"_n, "transfer"_n, trailing );
+
+   auto long_memo = transfer_data( "alice"_n, "bob"_n, 1, one, "" );
+   long_memo.back() = 0x10;                        // memo announces 16 bytes, none follow
+   require_same_outcome( "alice"_n, "transfer"_n, long_memo );
+
+   for ( auto act : { "transfer"_n, "issue"_n, "retire"_n } )
+      require_same_outcome( "alice"_n, act, bytes() );
+
+   require_same_rows( { 1 }, { "alice"_n, "bob"_n } );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( every_abi_action_dispatched, ntoken_dispatch_tester ) try {
+   // empty data fails while decoding the arguments in both builds, an action missing
+   // from NTOKEN_EXECUTED_ACTIONS fails with "unknown action" in the custom one instead
+   for ( const auto& act : abi.actions ) {
+      BOOST_TEST_CONTEXT( act.name.to_string() ) {
+         auto fast = push_raw( FAST, "alice"_n, act.name, bytes() );
+         BOOST_REQUIRE( fast.find( "unknown action" ) == string::npos );
+         BOOST_REQUIRE_EQUAL( push_raw( GEN, "alice"_n, act.name, bytes() ), fast );
+      }
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include "flon.ntoken_tester.hpp"
+
+#include <numeric>
+
+class ntoken_notary_tester : public ntoken_tester {
+public:
+   action_result setnotary( const name& notary, const bool& to_add ) {
+      return push_action( code, "setnotary"_n, mvo()( "notary", notary )( "to_add", to_add ) );
+   }
+
+   mvo batch_data( const name& notary, const vector<uint32_t>& ids ) {
+      return mvo()( "notary", notary )( "token_ids", ids );
+   }
+
+   static vector<uint32_t> id_range( const uint32_t& first, const uint32_t& count ) {
+      vector<uint32_t> ids( count );
+      std::iota( ids.begin(), ids.end(), first );
+      return ids;
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_notary_tests)
+
+BOOST_FIXTURE_TEST_CASE( notarizebatch_skips_own_rows, ntoken_notary_tester ) try {
+   create_many( "alice"_n, 1, 1, 3 );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "not authorized notary" ), push_action( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, { 1 } ) ) );
+
+   BOOST_REQUIRE_EQUAL( success(), setnotary( "dave"_n, true ) );
+   BOOST_REQUIRE_EQUAL( success(), setnotary( "carol"_n, true ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "no token ids" ), push_action( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, {} ) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token not found: 9" ), push_action( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, { 1, 9 } ) ) );
+   BOOST_REQUIRE_EQUAL( "", token( 1 )["notary"].as_string() );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( "carol"_n, "notarize"_n, mvo()( "notary", "carol" )( "token_id", 3 ) ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, { 1, 2, 1 } ) ) );
+   auto notarized_at = token( 1 )["notarized_at"].as_string();
+   produce_blocks( 2 );
+
+   // rows dave already notarized keep their timestamp, carol's row is taken over
+   BOOST_REQUIRE_EQUAL( success(), push_action( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, { 1, 3 } ) ) );
+   BOOST_REQUIRE_EQUAL( notarized_at, token( 1 )["notarized_at"].as_string() );
+   for ( uint32_t id : { 1, 2, 3 } )
+      BOOST_REQUIRE_EQUAL( "dave", token( id )["notary"].as_string() );
+   BOOST_REQUIRE_EQUAL( 3, get_singleton( "gstats"_n, "gstats_t" )["notarized"].as_uint64() );
+
+   BOOST_REQUIRE_EQUAL( success(), setnotary( "dave"_n, false ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "not authorized notary" ), push_action( "dave"_n, "notarize"_n, mvo()( "notary", "dave" )( "token_id", 1 ) ) );
+} FC_LOG_AND_RETHROW()
+
+/// CPU per token of notarizebatch for batch sizes 1 to 500, against one notarize per token
+BOOST_FIXTURE_TEST_CASE( notarizebatch_cpu_per_token, ntoken_notary_tester ) try {
+   const vector<uint32_t> sizes = { 1, 10, 50, 100, 500 };
+   const uint32_t total = std::accumulate( sizes.begin(), sizes.end(), 0u );
+   create_many( "alice"_n, 1, 1, total * 2 );
+   BOOST_REQUIRE_EQUAL( success(), setnotary( "dave"_n, true ) );
+
+   uint32_t next = 1;
+   for ( auto size : sizes ) {
+      auto batched = measure( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, id_range( next, size ) ) );
+      next += size;
+
+      vector<action> singles;
+      for ( auto id : id_range( next, size ) )
+         singles.push_back( make_action( "dave"_n, "notarize"_n, mvo()( "notary", "dave" )( "token_id", id ) ) );
+      auto single = measure( "dave"_n, std::move(singles) );
+      next += size;
+
+      auto n = std::to_string( size );
+      bench( "notarizebatch_cpu_us_per_token_" + n, batched.cpu_us / size );
+      bench( "notarize_cpu_us_per_token_" + n, single.cpu_us / size );
+   }
+   BOOST_REQUIRE_EQUAL( "dave", token( next - 1 )["notary"].as_string() );
+} FC_LOG_AND_RETHROW()
+
+/// RAM the notary pays per series id, each of which gets its own `tokenstats` row
+BOOST_FIXTURE_TEST_CASE( notarizebatch_series_ram, ntoken_notary_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), push_action( "alice"_n, "createseries"_n, mvo()( "issuer", "alice" )( "pid", 100 )
+      ( "first_id", 1 )( "last_id", 1000 )( "maximum_supply", 1 )( "uri_base", "col://" )( "ipowner", "" ) ) );
+   BOOST_REQUIRE_EQUAL( success(), setnotary( "dave"_n, true ) );
+
+   auto before = ram_usage( "dave"_n );
+   BOOST_REQUIRE_EQUAL( success(), push_action( "dave"_n, "notarizebatch"_n, batch_data( "dave"_n, id_range( 1, 100 ) ) ) );
+   bench( "series_notarize_ram_bytes_per_id", ( ram_usage( "dave"_n ) - before ) / 100 );
+   BOOST_REQUIRE_EQUAL( "col://100", token( 100 )["token_uri"].as_string() );
+} FC_LOG_AND_RETHROW()
+
+/// CPU of success paths whose checks format their message only on failure, and of the
+/// sorted notary list with one and with two hundred notaries
+BOOST_FIXTURE_TEST_CASE( check_and_list_cpu, ntoken_notary_tester ) try {
+   bench( "create_cpu_us", measure( "alice"_n, "create"_n, create_data( "alice"_n, 1, 1 ) ).cpu_us );
+   BOOST_REQUIRE_EQUAL( success(), setnotary( "dave"_n, true ) );
+   bench( "notarize_1_notary_cpu_us", measure( "dave"_n, "notarize"_n, mvo()( "notary", "dave" )( "token_id", 1 ) ).cpu_us );
+
+   vector<action> notaries;
+   for ( uint32_t n = 0; n < 200; n++ ) {
+      string suffix;
+      for ( uint32_t v = n, d = 0; d < 3; d++, v /= 26 )
+         suffix.insert( suffix.begin(), char( 'a' + v % 26 ) );
+      notaries.push_back( make_action( code, "setnotary"_n, mvo()( "notary", "notary" + suffix )( "to_add", true ) ) );
+   }
+   push_actions( code, std::move(notaries) );
+   produce_block();
+
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1, 2 ) );
+   bench( "setnotary_201_notaries_cpu_us", measure( code, "setnotary"_n, mvo()( "notary", "zed" )( "to_add", true ) ).cpu_us );
+   bench( "notarize_202_notaries_cpu_us", measure( "dave"_n, "notarize"_n, mvo()( "notary", "dave" )( "token_id", 2 ) ).cpu_us );
+   BOOST_REQUIRE_EQUAL( "dave", token( 2 )["notary"].as_string() );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
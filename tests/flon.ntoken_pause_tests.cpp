@@ -0,0 +1,63 @@
+#include "flon.ntoken_tester.hpp"
+
+class ntoken_pause_tester : public ntoken_tester {
+public:
+   action_result pausepid( const uint32_t& pid, const bool& paused, const name& signer = NTOKEN ) {
+      return push_action( signer, "pausepid"_n, mvo()( "pid", pid )( "paused", paused ) );
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_pause_tests)
+
+BOOST_FIXTURE_TEST_CASE( pausepid_freezes_collection, ntoken_pause_tester ) try {
+   create_many( "alice"_n, 10, 1, 3, 5 );
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 10, 4 ) );
+   for ( uint32_t id = 1; id <= 3; id++ )
+      BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 5, id, 5 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 5, 4 ) );
+
+   BOOST_REQUIRE_EQUAL( error( "missing authority of flon.ntoken" ), pausepid( 5, true, "alice"_n ) );
+   BOOST_REQUIRE_EQUAL( success(), pausepid( 5, true ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "parent already paused: 5" ), pausepid( 5, true ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token parent is paused: 5" ), issue( "alice"_n, "alice"_n, 1, 1, 5 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token parent is paused: 5" ), transfer( "alice"_n, "bob"_n, 1, 2, 5 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token parent is paused: 5" ), push_action( "alice"_n, "transfermany"_n, mvo()
+      ( "from", "alice" )( "recipients", vector<variant>{ mvo()( "to", "bob" )( "assets", vector<variant>{ nasset( 1, 3, 5 ) } ) } )
+      ( "memo", "" ) ) );
+   // other parents are not affected
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 1, 4 ) );
+
+   BOOST_REQUIRE_EQUAL( success(), pausepid( 5, false ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "parent not paused: 5" ), pausepid( 5, false ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 1, 2, 5 ) );
+   BOOST_REQUIRE_EQUAL( 1, balance( "bob"_n, 2, 5 ) );
+} FC_LOG_AND_RETHROW()
+
+/// freezing is one row write, and the transfer check is one point lookup however many parents are paused
+BOOST_FIXTURE_TEST_CASE( pausepid_cost, ntoken_pause_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 10, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 1, 1 ) );
+
+   bench( "transfer_0_paused_cpu_us", measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )
+      ( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) ).cpu_us );
+
+   auto before = ram_usage( NTOKEN );
+   auto paused = measure( NTOKEN, "pausepid"_n, mvo()( "pid", 1'000'000 )( "paused", true ) );
+   bench( "pausepid_cpu_us", paused.cpu_us );
+   bench( "pausepid_ram_bytes", ram_usage( NTOKEN ) - before );
+
+   for ( uint32_t first = 1; first <= 1000; first += 100 ) {
+      vector<action> pauses;
+      for ( uint32_t pid = first; pid < first + 100; pid++ )
+         pauses.push_back( make_action( NTOKEN, "pausepid"_n, mvo()( "pid", 2'000 + pid )( "paused", true ) ) );
+      push_actions( NTOKEN, std::move(pauses) );
+      produce_block();
+   }
+   bench( "transfer_1001_paused_cpu_us", measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )
+      ( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) ).cpu_us );
+   BOOST_REQUIRE_EQUAL( 3, balance( "bob"_n, 1 ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+#include "flon.ntoken_tester.hpp"
+
+/**
+ * Scaling load generator for flon.ntoken.
+ *
+ * Grows the state step by step (tokens, holder accounts and balance rows, all set up
+ * with batched transactions) and after each step pushes a fixed set of probe actions,
+ * recording the CPU and NET billed to each of them. The resulting CSV is a scaling
+ * curve: a flat line per action is expected, a rising one points at a code path whose
+ * cost grows with state size.
+ *
+ * The defaults keep the suite quick; set these to scale it up, e.g. to millions of rows:
+ *   NTOKEN_SCALE_STEPS     number of scale steps            (default 3)
+ *   NTOKEN_SCALE_TOKENS    tokens created per step          (default 20)
+ *   NTOKEN_SCALE_HOLDERS   holder accounts created per step (default 20)
+ *   NTOKEN_SCALE_BATCH     actions per setup transaction    (default 50)
+ *   NTOKEN_SCALE_REPORT    report file                      (default ntoken_scaling_report.csv)
+ */
+class ntoken_scaling_tester : public ntoken_tester {
+public:
+   static constexpr name ISSUER = "alice"_n;
+   // token ids of the generator start high to stay clear of the probe tokens
+   static constexpr uint32_t ID_BASE = 500'000'000;
+
+   static uint32_t param( const char* var, const uint32_t& def ) {
+      auto value = std::getenv( var );
+      return value ? std::stoul( value ) : def;
+   }
+
+   /// maps an integer onto a 12 character account name: "lg" + 10 base-31 digits
+   static name holder_name( uint64_t n ) {
+      static const string chars = "abcdefghijklmnopqrstuvwxyz12345";
+      string out;
+      for ( int d = 0; d < 10; d++, n /= 31 )
+         out.insert( out.begin(), chars[ n % 31 ] );
+      return name( "lg" + out );
+   }
+
+   /// queues `act` and pushes the queue as one transaction once it holds `batch` actions
+   void queue( action act, const uint32_t& batch ) {
+      _queued.push_back( std::move(act) );
+      if ( _queued.size() >= batch ) flush();
+   }
+
+   void flush() {
+      if ( _queued.empty() ) return;
+      push_actions( ISSUER, std::move(_queued) );
+      _queued.clear();
+      produce_block();
+   }
+
+   /// `tokens,holders,balances` as counted by `gstats`
+   string gstats_columns() {
+      auto row = get_singleton( "gstats"_n, "gstats_t" );
+      BOOST_REQUIRE( !row.is_null() );
+      return row["tokens"].as_string() + "," + row["holders"].as_string() + "," + row["balances"].as_string();
+   }
+
+   /// pushes one probe action in its own transaction and appends its billed CPU/NET to `report`
+   void probe( std::ofstream& report, const uint32_t& step, const action_name& act, const variant_object& data ) {
+      auto trace = push_actions( ISSUER, { make_action( ISSUER, act, data ) } );
+      produce_block();
+      BOOST_REQUIRE( trace->receipt );
+
+      auto line = std::to_string(step) + "," + gstats_columns() + "," + act.to_string() + ","
+                + std::to_string( trace->receipt->cpu_usage_us ) + ","
+                + std::to_string( trace->receipt->net_usage_words.value * 8 );
+      report << line << std::endl;
+      BOOST_TEST_MESSAGE( line );
+   }
+
+   vector<action> _queued;
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_scaling_tests)
+
+BOOST_FIXTURE_TEST_CASE( scaling_curve, ntoken_scaling_tester ) try {
+   const auto steps     = param( "NTOKEN_SCALE_STEPS", 3 );
+   const auto tokens    = param( "NTOKEN_SCALE_TOKENS", 20 );
+   const auto holders   = param( "NTOKEN_SCALE_HOLDERS", 20 );
+   const auto batch     = param( "NTOKEN_SCALE_BATCH", 50 );
+   const auto path      = std::getenv( "NTOKEN_SCALE_REPORT" );
+   BOOST_REQUIRE( holders > 0 && batch > 0 );
+
+   std::ofstream report( path ? path : "ntoken_scaling_report.csv" );
+   report << "step,tokens,holders,balances,action,cpu_us,net_bytes" << std::endl;
+
+   for ( uint32_t step = 1; step <= steps; step++ ) {
+      const uint32_t first_token  = ID_BASE + (step - 1) * tokens;
+      const uint64_t first_holder = uint64_t(step - 1) * holders;
+
+      vector<name> names;
+      for ( uint32_t i = 0; i < holders; i++ )
+         names.push_back( holder_name( first_holder + i ) );
+      for ( uint32_t i = 0; i < holders; i += batch ) {
+         create_accounts( vector<name>( names.begin() + i, names.begin() + std::min( i + batch, holders ) ) );
+         produce_block();
+      }
+
+      // every token gets one unit per holder of this step, issued then spread with transfermany
+      for ( uint32_t i = 0; i < tokens; i++ ) {
+         const auto id = first_token + i;
+         queue( make_action( ISSUER, "create"_n, mvo()( "issuer", ISSUER )( "maximum_supply", holders )
+            ( "symbol", nsymbol( id ) )( "token_uri", "lg://" + std::to_string(id) )( "ipowner", "" ) ), batch );
+         queue( make_action( ISSUER, "issue"_n, mvo()( "to", ISSUER )( "quantity", nasset( holders, id ) )( "memo", "" ) ), batch );
+      }
+      flush();
+
+      for ( uint32_t i = 0; i < tokens; i++ ) {
+         const auto id = first_token + i;
+         for ( uint32_t h = 0; h < holders; h += batch ) {
+            vector<variant> recipients;
+            for ( uint32_t j = h; j < std::min( h + batch, holders ); j++ )
+               recipients.push_back( mvo()( "to", names[j] )( "assets", vector<variant>{ nasset( 1, id ) } ) );
+            queue( make_action( ISSUER, "transfermany"_n, mvo()( "from", ISSUER )( "recipients", recipients )( "memo", "" ) ), 1 );
+         }
+      }
+
+      // probes, on a fresh token so they do not depend on earlier steps
+      const uint32_t probe_id = ID_BASE - step;
+      probe( report, step, "create"_n, mvo()( "issuer", ISSUER )( "maximum_supply", 10 )( "symbol", nsymbol( probe_id ) )
+         ( "token_uri", "lg://probe/" + std::to_string(step) )( "ipowner", "" ) );
+      probe( report, step, "issue"_n, mvo()( "to", ISSUER )( "quantity", nasset( 10, probe_id ) )( "memo", "" ) );
+      probe( report, step, "transfer"_n, mvo()( "from", ISSUER )( "to", names.front() )
+         ( "assets", vector<variant>{ nasset( 1, probe_id ) } )( "memo", "" ) );
+      probe( report, step, "retire"_n, mvo()( "quantity", nasset( 1, probe_id ) )( "memo", "" ) );
+
+      BOOST_REQUIRE_EQUAL( 1, balance( names.back(), first_token ) );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+#include "flon.ntoken_tester.hpp"
+
+class ntoken_series_tester : public ntoken_tester {
+public:
+   action_result createseries( const name& issuer, const uint32_t& pid, const uint32_t& first_id, const uint32_t& last_id,
+                               const int64_t& maximum_supply, const string& uri_base ) {
+      return push_action( issuer, "createseries"_n, mvo()( "issuer", issuer )( "pid", pid )( "first_id", first_id )
+         ( "last_id", last_id )( "maximum_supply", maximum_supply )( "uri_base", uri_base )( "ipowner", "" ) );
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_series_tests)
+
+BOOST_FIXTURE_TEST_CASE( series_issue_transfer_retire, ntoken_series_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), createseries( "alice"_n, 100, 1, 10, 1, "col://" ) );
+   BOOST_REQUIRE( token( 1 ).is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 1, 1, 100 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "series tokens are issued in id order, next: 2" ), issue( "alice"_n, "alice"_n, 1, 3, 100 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol mismatch" ), issue( "alice"_n, "alice"_n, 1, 2, 7 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "tokens can only be issued to issuer account" ), issue( "alice"_n, "bob"_n, 1, 2, 100 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 1, 2, 100 ) );
+   // issuing resolves through the range row, no tokenstats row is written
+   BOOST_REQUIRE( token( 1 ).is_null() );
+   BOOST_REQUIRE( token( 2 ).is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 1, 1, 100 ) );
+   BOOST_REQUIRE_EQUAL( 0, balance( "alice"_n, 1, 100 ) );
+   BOOST_REQUIRE_EQUAL( 1, balance( "bob"_n, 1, 100 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol precision mismatch" ), transfer( "bob"_n, "carol"_n, 1, 1, 0 ) );
+
+   // retiring diverges the id from its range, so its row is materialized and paid by the issuer
+   BOOST_REQUIRE_EQUAL( success(), push_action( "alice"_n, "retire"_n, mvo()( "quantity", nasset( 1, 2, 100 ) )( "memo", "" ) ) );
+   auto row = token( 2 );
+   BOOST_REQUIRE( !row.is_null() );
+   BOOST_REQUIRE_EQUAL( 0, row["supply"]["amount"].as_int64() );
+   BOOST_REQUIRE_EQUAL( "col://2", row["token_uri"].as_string() );
+   BOOST_REQUIRE_EQUAL( "alice", row["issuer"].as_string() );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( series_ids_are_reserved, ntoken_series_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1, 20 ) );
+   BOOST_REQUIRE_EQUAL( success(), createseries( "alice"_n, 31, 21, 30, 1, "col://" ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "series overlaps an existing series" ), createseries( "bob"_n, 0, 30, 40, 1, "other://" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "series overlaps existing tokens" ), createseries( "bob"_n, 0, 10, 20, 1, "other://" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "series with uri_base already exists" ), createseries( "bob"_n, 0, 50, 60, 1, "col://" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "parent id shall not be inside the series" ), createseries( "bob"_n, 55, 50, 60, 1, "other://" ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token of ID: 25 belongs to a series" ), create( "bob"_n, 1, 25 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token of ID: 31 is the parent of a series" ), create( "bob"_n, 1, 31 ) );
+
+   // an automatic id skips the range [21, 30] and the series parent 31
+   BOOST_REQUIRE_EQUAL( success(), create( "bob"_n, 1, 0 ) );
+   BOOST_REQUIRE( !token( 32 ).is_null() );
+   BOOST_REQUIRE_EQUAL( "bob", token( 32 )["issuer"].as_string() );
+} FC_LOG_AND_RETHROW()
+
+/// RAM of a 10k-edition collection as one series row and as one `tokenstats` row per id
+BOOST_FIXTURE_TEST_CASE( series_ram_10k, ntoken_series_tester ) try {
+   const uint32_t editions = 10'000;
+
+   auto before = ram_usage( "alice"_n );
+   BOOST_REQUIRE_EQUAL( success(), createseries( "alice"_n, 100, 1, editions, 1, "col://" ) );
+   auto series_ram = ram_usage( "alice"_n ) - before;
+
+   before = ram_usage( "bob"_n );
+   create_many( "bob"_n, 1, 20'001, editions, 200 );
+   auto tokens_ram = ram_usage( "bob"_n ) - before;
+
+   bench( "series_ram_bytes", series_ram );
+   bench( "tokenstats_ram_bytes", tokens_ram );
+   bench( "tokenstats_ram_bytes_per_id", tokens_ram / editions );
+
+   // an id that diverges from the range costs one full row, as notarizing does per id
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 1, 1, 100 ) );
+   before = ram_usage( "alice"_n );
+   BOOST_REQUIRE_EQUAL( success(), push_action( "alice"_n, "retire"_n, mvo()( "quantity", nasset( 1, 1, 100 ) )( "memo", "" ) ) );
+   bench( "materialized_row_ram_bytes", ram_usage( "alice"_n ) - before );
+
+   BOOST_REQUIRE( series_ram < tokens_ram / editions * 2 );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
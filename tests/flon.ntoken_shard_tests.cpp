@@ -0,0 +1,78 @@
+#include "flon.ntoken_tester.hpp"
+
+class ntoken_shard_tester : public ntoken_tester {
+public:
+   action_result setsharding( const uint32_t& shard_size, const name& signer = NTOKEN ) {
+      return push_action( signer, "setsharding"_n, mvo()( "shard_size", shard_size ) );
+   }
+
+   action_result migrateshard( const uint32_t& max_rows ) {
+      return push_action( NTOKEN, "migrateshard"_n, mvo()( "max_rows", max_rows ) );
+   }
+
+   action_result create_with_uri( const name& issuer, const uint32_t& id, const string& token_uri ) {
+      return push_action( issuer, "create"_n, create_data( issuer, 1, id )( "token_uri", token_uri ) );
+   }
+
+   variant shardconf() {
+      return get_singleton( "shardconf"_n, "shardconf_t" );
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_shard_tests)
+
+BOOST_FIXTURE_TEST_CASE( shard_and_migrate, ntoken_shard_tester ) try {
+   create_many( "alice"_n, 10, 1, 5 );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 1 ) );
+
+   BOOST_REQUIRE_EQUAL( error( "missing authority of flon.ntoken" ), setsharding( 10, "alice"_n ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "shard size must be positive" ), setsharding( 0 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "tokenstats not sharded" ), migrateshard( 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), setsharding( 10 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "tokenstats already sharded" ), setsharding( 20 ) );
+   BOOST_REQUIRE_EQUAL( 10, shardconf()["shard_size"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 6, shardconf()["next_id"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( false, shardconf()["migrated"].as_bool() );
+
+   // new rows go to their shard, legacy rows stay readable in place until migrated
+   BOOST_REQUIRE_EQUAL( success(), create( "bob"_n, 10, 0 ) );
+   BOOST_REQUIRE( token( 6 ).is_null() );
+   BOOST_REQUIRE_EQUAL( "bob", token( 6, 0 )["issuer"].as_string() );
+   BOOST_REQUIRE_EQUAL( success(), create( "bob"_n, 10, 25 ) );
+   BOOST_REQUIRE( !token( 25, 2 ).is_null() );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token with token_uri already exists" ), create_with_uri( "bob"_n, 30, "uri://1" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "series overlaps existing tokens" ), push_action( "bob"_n, "createseries"_n, mvo()
+      ( "issuer", "bob" )( "pid", 0 )( "first_id", 20 )( "last_id", 29 )( "maximum_supply", 1 )( "uri_base", "s://" )( "ipowner", "" ) ) );
+
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 1, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 2 ) );
+
+   // moved rows are paid by the contract and released from their issuer
+   auto alice_before = ram_usage( "alice"_n );
+   auto self_before  = ram_usage( NTOKEN );
+   BOOST_REQUIRE_EQUAL( success(), migrateshard( 2 ) );
+   BOOST_REQUIRE( token( 1 ).is_null() );
+   BOOST_REQUIRE_EQUAL( 10, token( 1, 0 )["supply"]["amount"].as_int64() );
+   BOOST_REQUIRE( !token( 3 ).is_null() );
+   BOOST_REQUIRE_EQUAL( false, shardconf()["migrated"].as_bool() );
+   bench( "migrated_row_ram_released_bytes", ( alice_before - ram_usage( "alice"_n ) ) / 2 );
+   bench( "migrated_row_ram_charged_bytes", ( ram_usage( NTOKEN ) - self_before ) / 2 );
+
+   BOOST_REQUIRE_EQUAL( success(), migrateshard( 100 ) );
+   BOOST_REQUIRE_EQUAL( true, shardconf()["migrated"].as_bool() );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "tokenstats already migrated" ), migrateshard( 1 ) );
+   for ( uint32_t id = 1; id <= 5; id++ ) {
+      BOOST_REQUIRE( token( id ).is_null() );
+      BOOST_REQUIRE( !token( id, 0 ).is_null() );
+   }
+
+   // uris stay unique across shards once the legacy index is gone
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token with token_uri already exists" ), create_with_uri( "bob"_n, 40, "uri://3" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token with token_uri already exists" ), create_with_uri( "bob"_n, 40, "uri://25" ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 3 ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( "alice"_n, "bob"_n, 2, 3 ) );
+   BOOST_REQUIRE_EQUAL( 2, balance( "bob"_n, 3 ) );
+   BOOST_REQUIRE_EQUAL( 1, balance( "bob"_n, 1 ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,181 @@
+#pragma once
+#include <boost/test/unit_test.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/resource_limits.hpp>
+#include <eosio/testing/tester.hpp>
+
+#include <fc/variant_object.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+
+#include "contracts.hpp"
+
+using namespace eosio::testing;
+using namespace eosio;
+using namespace eosio::chain;
+using namespace fc;
+using namespace std;
+
+using mvo = fc::mutable_variant_object;
+
+/**
+ * Deploys a token contract, flon.ntoken to `flon.ntoken` unless told otherwise, and pushes
+ * its actions through the ABI. Both contracts share the `nasset`, `tokenstats` and `accounts`
+ * layouts the readers below rely on.
+ */
+class ntoken_tester : public tester {
+public:
+   static constexpr name NTOKEN = "flon.ntoken"_n;
+
+   /// CPU and NET billed to a transaction
+   struct usage {
+      int64_t cpu_us;
+      int64_t net_bytes;
+   };
+
+   explicit ntoken_tester( const name& code = NTOKEN, const vector<uint8_t>& wasm = contracts::ntoken_wasm(),
+                           const vector<char>& abi_json = contracts::ntoken_abi() ): code( code ) {
+      produce_blocks( 2 );
+      create_accounts( { "alice"_n, "bob"_n, "carol"_n, "dave"_n, code } );
+      produce_blocks( 2 );
+
+      set_code( code, wasm );
+      set_abi( code, abi_json.data() );
+      produce_blocks();
+
+      const auto& accnt = control->db().get<account_object,by_name>( code );
+      abi_def abi;
+      BOOST_REQUIRE_EQUAL( abi_serializer::to_abi(accnt.abi, abi), true );
+      abi_ser.set_abi( abi, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   action make_action( const account_name& signer, const action_name& name, const variant_object& data ) {
+      action act;
+      act.account       = code;
+      act.name          = name;
+      act.authorization = vector<permission_level>{ { signer, config::active_name } };
+      act.data          = abi_ser.variant_to_binary( abi_ser.get_action_type(name), data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+      return act;
+   }
+
+   action_result push_action( const account_name& signer, const action_name& name, const variant_object& data ) {
+      return base_tester::push_action( make_action( signer, name, data ), signer.to_uint64_t() );
+   }
+
+   /// pushes `actions` as one transaction signed by `signer`, throws when it fails
+   transaction_trace_ptr push_actions( const account_name& signer, vector<action> actions ) {
+      signed_transaction trx;
+      trx.actions = std::move( actions );
+      set_transaction_headers( trx );
+      trx.sign( get_private_key( signer, "active" ), control->get_chain_id() );
+      return push_transaction( trx );
+   }
+
+   /// pushes `actions` as one transaction in its own block and returns what it was billed
+   usage measure( const account_name& signer, vector<action> actions ) {
+      auto trace = push_actions( signer, std::move(actions) );
+      produce_block();
+      BOOST_REQUIRE( trace->receipt );
+      return { trace->receipt->cpu_usage_us, int64_t( trace->receipt->net_usage_words.value ) * 8 };
+   }
+
+   usage measure( const account_name& signer, const action_name& name, const variant_object& data ) {
+      return measure( signer, { make_action( signer, name, data ) } );
+   }
+
+   int64_t ram_usage( const name& account ) {
+      return control->get_resource_limits_manager().get_account_ram_usage( account );
+   }
+
+   /**
+    * Records one benchmark number: logged, and appended to the CSV named by NTOKEN_BENCH_REPORT
+    * (default ntoken_bench_report.csv) as `suite,case,metric,value`.
+    */
+   static void bench( const string& metric, const int64_t& value ) {
+      auto& test = boost::unit_test::framework::current_test_case();
+      auto suite = boost::unit_test::framework::get<boost::unit_test::test_suite>( test.p_parent_id ).p_name.get();
+      auto line  = suite + "," + test.p_name.get() + "," + metric + "," + std::to_string( value );
+
+      auto path = std::getenv( "NTOKEN_BENCH_REPORT" );
+      std::ofstream report( path ? path : "ntoken_bench_report.csv", std::ios::app );
+      report << line << std::endl;
+      BOOST_TEST_MESSAGE( line );
+   }
+
+   static mvo nsymbol( const uint32_t& id, const uint32_t& pid = 0 ) {
+      return mvo()( "id", id )( "pid", pid );
+   }
+
+   static mvo nasset( const int64_t& amount, const uint32_t& id, const uint32_t& pid = 0 ) {
+      return mvo()( "amount", amount )( "symbol", nsymbol( id, pid ) );
+   }
+
+   static uint64_t raw( const uint32_t& id, const uint32_t& pid = 0 ) {
+      return uint64_t(pid) * 1'000'000'000 + id;
+   }
+
+   mvo create_data( const name& issuer, const int64_t& maximum_supply, const uint32_t& id, const uint32_t& pid = 0 ) {
+      return mvo()( "issuer", issuer )( "maximum_supply", maximum_supply )( "symbol", nsymbol( id, pid ) )
+                  ( "token_uri", "uri://" + std::to_string(raw( id, pid )) )( "ipowner", "" );
+   }
+
+   action_result create( const name& issuer, const int64_t& maximum_supply, const uint32_t& id, const uint32_t& pid = 0 ) {
+      return push_action( issuer, "create"_n, create_data( issuer, maximum_supply, id, pid ) );
+   }
+
+   /// creates tokens `[first_id, first_id + count)` under `pid`, 50 creates per transaction
+   void create_many( const name& issuer, const int64_t& maximum_supply, const uint32_t& first_id, const uint32_t& count,
+                     const uint32_t& pid = 0 ) {
+      const uint32_t batch = 50;
+      for ( uint32_t i = 0; i < count; i += batch ) {
+         vector<action> actions;
+         for ( uint32_t id = first_id + i; id < first_id + std::min( i + batch, count ); id++ )
+            actions.push_back( make_action( issuer, "create"_n, create_data( issuer, maximum_supply, id, pid ) ) );
+         push_actions( issuer, std::move(actions) );
+         produce_block();
+      }
+   }
+
+   action_result issue( const name& issuer, const name& to, const int64_t& amount, const uint32_t& id, const uint32_t& pid = 0 ) {
+      return push_action( issuer, "issue"_n, mvo()( "to", to )( "quantity", nasset( amount, id, pid ) )( "memo", "" ) );
+   }
+
+   action_result transfer( const name& from, const name& to, const int64_t& amount, const uint32_t& id, const uint32_t& pid = 0 ) {
+      return push_action( from, "transfer"_n, mvo()( "from", from )( "to", to )
+         ( "assets", vector<variant>{ nasset( amount, id, pid ) } )( "memo", "" ) );
+   }
+
+   /// the row of `table` in `scope` under `key` as a variant of ABI type `type`, null when missing
+   variant get_row( const name& scope, const name& table, const uint64_t& key, const string& type ) {
+      auto data = get_row_by_account( code, scope, table, name(key) );
+      if ( data.empty() ) return variant();
+      return abi_ser.binary_to_variant( type, data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   variant get_singleton( const name& table, const string& type ) {
+      return get_row( code, table, table.to_uint64_t(), type );
+   }
+
+   /// `0` when `owner` has no balance row of the token
+   int64_t balance( const name& owner, const uint32_t& id, const uint32_t& pid = 0 ) {
+      auto row = get_row( owner, "accounts"_n, raw( id, pid ), "account_t" );
+      return row.is_null() ? 0 : row["balance"]["amount"].as_int64();
+   }
+
+   /// `tokenstats` row of `id` in shard `scope`, or in the contract scope
+   variant token( const uint32_t& id, const std::optional<uint64_t>& scope = {} ) {
+      return get_row( scope ? name(*scope) : code, "tokenstats"_n, id, "nstats_t" );
+   }
+
+   int64_t supply( const uint32_t& id ) {
+      auto row = token( id );
+      BOOST_REQUIRE( !row.is_null() );
+      return row["supply"]["amount"].as_int64();
+   }
+
+   const name      code;
+   abi_serializer  abi_ser;
+};
@@ -0,0 +1,278 @@
+#include "flon.ntoken_tester.hpp"
+
+class ntoken_transfer_tester : public ntoken_tester {
+public:
+   static mvo recipient( const name& to, const vector<variant>& assets ) {
+      return mvo()( "to", to )( "assets", assets );
+   }
+
+   action_result transfermany( const name& from, const vector<variant>& recipients ) {
+      return push_action( from, "transfermany"_n, mvo()( "from", from )( "recipients", recipients )( "memo", "" ) );
+   }
+
+   static mvo ntransfer( const name& from, const name& to, const int64_t& amount, const uint32_t& id ) {
+      return mvo()( "from", from )( "to", to )( "quantity", nasset( amount, id ) );
+   }
+
+   action_result transferfrom( const name& op, const vector<variant>& transfers ) {
+      return push_action( op, "transferfrom"_n, mvo()( "op", op )( "transfers", transfers )( "memo", "" ) );
+   }
+
+   action_result approve( const name& owner, const name& op, const vector<variant>& symbols, const bool& approved ) {
+      return push_action( owner, "approve"_n, mvo()( "owner", owner )( "op", op )( "symbols", symbols )( "approved", approved ) );
+   }
+
+   static void append_varuint( bytes& out, uint64_t value ) {
+      do {
+         uint8_t b = value & 0x7f;
+         value >>= 7;
+         out.push_back( char( value ? b | 0x80 : b ) );
+      } while ( value );
+   }
+
+   /// the `transferpk` encoding of `amounts[i]` of token `ids[i]` under `pid`, ids ascending
+   static bytes pack_assets( const uint32_t& pid, const vector<uint32_t>& ids, const vector<int64_t>& amounts ) {
+      bool all_one = std::all_of( amounts.begin(), amounts.end(), []( auto a ) { return a == 1; } );
+      bytes out{ char( all_one ? 0x01 : 0x00 ) };
+      append_varuint( out, pid );
+      append_varuint( out, ids.size() );
+      for ( size_t i = 0; i < ids.size(); i++ )
+         append_varuint( out, i == 0 ? ids[0] : ids[i] - ids[i - 1] );
+      if ( all_one ) return out;
+
+      bytes bitmap( ( ids.size() + 7 ) / 8 );
+      for ( size_t i = 0; i < ids.size(); i++ )
+         if ( amounts[i] == 1 ) bitmap[i / 8] |= char( 1 << ( i % 8 ) );
+      out.insert( out.end(), bitmap.begin(), bitmap.end() );
+      for ( size_t i = 0; i < ids.size(); i++ )
+         if ( amounts[i] != 1 ) append_varuint( out, amounts[i] );
+      return out;
+   }
+
+   mvo transferpk_data( const name& from, const name& to, const bytes& packed ) {
+      return mvo()( "from", from )( "to", to )( "packed", packed )( "memo", "" );
+   }
+
+   /// `count` new account names starting with `prefix`
+   vector<name> new_accounts( const string& prefix, const uint32_t& count ) {
+      vector<name> names;
+      for ( uint32_t n = 0; n < count; n++ ) {
+         string suffix;
+         for ( uint32_t v = n, d = 0; d < 3; d++, v /= 26 )
+            suffix.insert( suffix.begin(), char( 'a' + v % 26 ) );
+         names.push_back( name( prefix + suffix ) );
+      }
+      create_accounts( names );
+      produce_block();
+      return names;
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(ntoken_transfer_tests)
+
+BOOST_FIXTURE_TEST_CASE( transfermany_moves_totals, ntoken_transfer_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1000, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1000, 2 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 100, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 2 ) );
+
+   BOOST_REQUIRE_EQUAL( success(), transfermany( "alice"_n, {
+      recipient( "bob"_n,   { nasset( 5, 1 ), nasset( 1, 2 ) } ),
+      recipient( "carol"_n, { nasset( 7, 1 ) } ),
+      recipient( "bob"_n,   { nasset( 3, 1 ) } ) } ) );
+
+   BOOST_REQUIRE_EQUAL( 85, balance( "alice"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 9,  balance( "alice"_n, 2 ) );
+   BOOST_REQUIRE_EQUAL( 8,  balance( "bob"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 1,  balance( "bob"_n, 2 ) );
+   BOOST_REQUIRE_EQUAL( 7,  balance( "carol"_n, 1 ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "overdrawn balance" ), transfermany( "alice"_n, {
+      recipient( "bob"_n, { nasset( 80, 1 ) } ), recipient( "carol"_n, { nasset( 6, 1 ) } ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "cannot transfer to self" ), transfermany( "alice"_n, {
+      recipient( "alice"_n, { nasset( 1, 1 ) } ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "no recipients" ), transfermany( "alice"_n, {} ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( transfermany_debit_overflow, ntoken_transfer_tester ) try {
+   const auto max = std::numeric_limits<int64_t>::max();
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, max, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 1, 1 ) );
+
+   // max + max + 3 wraps to 1, the balance alice holds
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "transfer amount overflow" ), transfermany( "alice"_n, {
+      recipient( "bob"_n,   { nasset( max, 1 ) } ),
+      recipient( "carol"_n, { nasset( max, 1 ) } ),
+      recipient( "dave"_n,  { nasset( 3, 1 ) } ) } ) );
+
+   BOOST_REQUIRE_EQUAL( 1, balance( "alice"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 0, balance( "bob"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 0, balance( "carol"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 0, balance( "dave"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 1, supply( 1 ) );
+} FC_LOG_AND_RETHROW()
+
+/// CPU of one transfermany against one transfer action per recipient, new balance rows in both
+BOOST_FIXTURE_TEST_CASE( transfermany_per_recipient_cpu, ntoken_transfer_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 1000, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 1000, 1 ) );
+
+   char round = 'a';
+   for ( uint32_t count : { 1, 10, 100 } ) {
+      auto many  = new_accounts( string( "many" ) + round, count );
+      auto plain = new_accounts( string( "plain" ) + round++, count );
+
+      vector<variant> recipients;
+      vector<action> transfers;
+      for ( uint32_t i = 0; i < count; i++ ) {
+         recipients.push_back( recipient( many[i], { nasset( 1, 1 ) } ) );
+         transfers.push_back( make_action( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", plain[i] )
+            ( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) ) );
+      }
+
+      auto batched = measure( "alice"_n, "transfermany"_n, mvo()( "from", "alice" )( "recipients", recipients )( "memo", "" ) );
+      auto single  = measure( "alice"_n, std::move(transfers) );
+      BOOST_REQUIRE_EQUAL( 1, balance( many.back(), 1 ) );
+      BOOST_REQUIRE_EQUAL( 1, balance( plain.back(), 1 ) );
+
+      auto n = std::to_string( count );
+      bench( "transfermany_cpu_us_per_recipient_" + n, batched.cpu_us / count );
+      bench( "transfer_cpu_us_per_recipient_" + n, single.cpu_us / count );
+      bench( "transfermany_net_bytes_" + n, batched.net_bytes );
+      bench( "transfer_net_bytes_" + n, single.net_bytes );
+   }
+} FC_LOG_AND_RETHROW()
+
+/// CPU of the hot paths that go through the per-action table cache
+BOOST_FIXTURE_TEST_CASE( transfer_issue_cpu, ntoken_transfer_tester ) try {
+   create_many( "alice"_n, 100, 1, 10 );
+
+   vector<variant> assets;
+   for ( uint32_t id = 1; id <= 10; id++ ) {
+      auto issued = measure( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 100, id ) )( "memo", "" ) );
+      if ( id == 1 ) bench( "issue_cpu_us", issued.cpu_us );
+      assets.push_back( nasset( 1, id ) );
+   }
+
+   auto one = measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )
+      ( "assets", vector<variant>{ nasset( 1, 1 ) } )( "memo", "" ) );
+   auto ten = measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "carol" )( "assets", assets )( "memo", "" ) );
+   auto again = measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "carol" )( "assets", assets )( "memo", "" ) );
+   bench( "transfer_1_asset_cpu_us", one.cpu_us );
+   bench( "transfer_10_assets_new_rows_cpu_us", ten.cpu_us );
+   bench( "transfer_10_assets_existing_rows_cpu_us", again.cpu_us );
+   BOOST_REQUIRE_EQUAL( 2, balance( "carol"_n, 10 ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( transferpk_matches_transfer, ntoken_transfer_tester ) try {
+   create_many( "alice"_n, 100, 1, 3, 7 );
+   for ( uint32_t id = 1; id <= 3; id++ )
+      BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 100, id, 7 ) );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( "alice"_n, "transferpk"_n,
+      transferpk_data( "alice"_n, "bob"_n, pack_assets( 7, { 1, 3 }, { 1, 1 } ) ) ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( "alice"_n, "transferpk"_n,
+      transferpk_data( "alice"_n, "bob"_n, pack_assets( 7, { 1, 2, 3 }, { 5, 1, 2 } ) ) ) );
+   BOOST_REQUIRE_EQUAL( 6, balance( "bob"_n, 1, 7 ) );
+   BOOST_REQUIRE_EQUAL( 1, balance( "bob"_n, 2, 7 ) );
+   BOOST_REQUIRE_EQUAL( 3, balance( "bob"_n, 3, 7 ) );
+   BOOST_REQUIRE_EQUAL( 94, balance( "alice"_n, 1, 7 ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "overdrawn balance" ), push_action( "alice"_n, "transferpk"_n,
+      transferpk_data( "alice"_n, "bob"_n, pack_assets( 7, { 2 }, { 300 } ) ) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "packed ids must be ascending" ), push_action( "alice"_n, "transferpk"_n,
+      transferpk_data( "alice"_n, "bob"_n, pack_assets( 7, { 2, 2 }, { 1, 1 } ) ) ) );
+
+   auto bad_flags = pack_assets( 7, { 1 }, { 1 } );
+   bad_flags[0] = 0x03;
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "unknown packed flags" ), push_action( "alice"_n, "transferpk"_n,
+      transferpk_data( "alice"_n, "bob"_n, bad_flags ) ) );
+
+   auto trailing = pack_assets( 7, { 1 }, { 1 } );
+   trailing.push_back( 0 );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "unexpected bytes after packed assets" ), push_action( "alice"_n, "transferpk"_n,
+      transferpk_data( "alice"_n, "bob"_n, trailing ) ) );
+} FC_LOG_AND_RETHROW()
+
+/// NET and CPU of transferpk against transfer for single-edition tokens under one parent
+BOOST_FIXTURE_TEST_CASE( transferpk_net_cpu, ntoken_transfer_tester ) try {
+   const uint32_t pid = 100, count = 50;
+   create_many( "alice"_n, 2, 1, count, pid );
+   vector<action> issues;
+   for ( uint32_t id = 1; id <= count; id++ )
+      issues.push_back( make_action( "alice"_n, "issue"_n, mvo()( "to", "alice" )( "quantity", nasset( 2, id, pid ) )( "memo", "" ) ) );
+   push_actions( "alice"_n, std::move(issues) );
+   produce_block();
+
+   for ( uint32_t n : { 1, 10, 50 } ) {
+      vector<variant> assets;
+      vector<uint32_t> ids;
+      for ( uint32_t id = 1; id <= n; id++ ) {
+         assets.push_back( nasset( 1, id, pid ) );
+         ids.push_back( id );
+      }
+
+      auto plain  = measure( "alice"_n, "transfer"_n, mvo()( "from", "alice" )( "to", "bob" )( "assets", assets )( "memo", "" ) );
+      auto packed = measure( "alice"_n, "transferpk"_n, transferpk_data( "alice"_n, "carol"_n,
+                                                                          pack_assets( pid, ids, vector<int64_t>( n, 1 ) ) ) );
+      BOOST_REQUIRE_EQUAL( balance( "bob"_n, n, pid ), balance( "carol"_n, n, pid ) );
+
+      auto suffix = std::to_string( n );
+      bench( "transfer_net_bytes_" + suffix, plain.net_bytes );
+      bench( "transferpk_net_bytes_" + suffix, packed.net_bytes );
+      bench( "transfer_cpu_us_" + suffix, plain.cpu_us );
+      bench( "transferpk_cpu_us_" + suffix, packed.cpu_us );
+      BOOST_REQUIRE( packed.net_bytes < plain.net_bytes );
+
+      // hand the assets back so every round starts from the same balances
+      for ( auto holder : { "bob"_n, "carol"_n } ) {
+         BOOST_REQUIRE_EQUAL( success(), push_action( holder, "transferpk"_n,
+            transferpk_data( holder, "alice"_n, pack_assets( pid, ids, vector<int64_t>( n, 1 ) ) ) ) );
+      }
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( transferfrom_settles_approved_batches, ntoken_transfer_tester ) try {
+   BOOST_REQUIRE_EQUAL( success(), create( "alice"_n, 100, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), create( "bob"_n, 100, 2 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "alice"_n, "alice"_n, 10, 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), issue( "bob"_n, "bob"_n, 10, 2 ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "operator not approved by alice" ),
+      transferfrom( "dave"_n, { ntransfer( "alice"_n, "carol"_n, 1, 1 ) } ) );
+
+   BOOST_REQUIRE_EQUAL( success(), approve( "alice"_n, "dave"_n, {}, true ) );
+   BOOST_REQUIRE_EQUAL( success(), approve( "bob"_n, "dave"_n, { nsymbol( 2 ) }, true ) );
+
+   BOOST_REQUIRE_EQUAL( success(), transferfrom( "dave"_n, {
+      ntransfer( "alice"_n, "carol"_n, 3, 1 ),
+      ntransfer( "bob"_n,   "carol"_n, 2, 2 ),
+      ntransfer( "alice"_n, "bob"_n,   1, 1 ),
+      ntransfer( "alice"_n, "carol"_n, 1, 1 ) } ) );
+   BOOST_REQUIRE_EQUAL( 5, balance( "alice"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 4, balance( "carol"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 1, balance( "bob"_n, 1 ) );
+   BOOST_REQUIRE_EQUAL( 8, balance( "bob"_n, 2 ) );
+   BOOST_REQUIRE_EQUAL( 2, balance( "carol"_n, 2 ) );
+
+   // bob approved dave for token 2 only
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "operator not approved for token 1 by bob" ),
+      transferfrom( "dave"_n, { ntransfer( "bob"_n, "carol"_n, 1, 1 ) } ) );
+
+   // each sender must hold its gross amount sent, assets received in the batch cannot be relayed
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "no balance object found" ), transferfrom( "dave"_n, {
+      ntransfer( "bob"_n, "alice"_n, 2, 2 ), ntransfer( "alice"_n, "carol"_n, 2, 2 ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "overdrawn balance" ), transferfrom( "dave"_n, {
+      ntransfer( "alice"_n, "bob"_n, 5, 1 ), ntransfer( "alice"_n, "carol"_n, 1, 1 ) } ) );
+
+   const auto max = std::numeric_limits<int64_t>::max();
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "transfer amount overflow" ), transferfrom( "dave"_n, {
+      ntransfer( "alice"_n, "bob"_n, max, 1 ), ntransfer( "alice"_n, "carol"_n, max, 1 ) } ) );
+
+   BOOST_REQUIRE_EQUAL( success(), approve( "alice"_n, "dave"_n, {}, false ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "operator not approved by alice" ),
+      transferfrom( "dave"_n, { ntransfer( "alice"_n, "carol"_n, 1, 1 ) } ) );
+   BOOST_REQUIRE_EQUAL( 5, balance( "alice"_n, 1 ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()